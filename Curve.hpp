@@ -0,0 +1,114 @@
+#ifndef GUARD_CURVE
+#define GUARD_CURVE
+
+// Traits of the supported curves y^2 = x^3 + a*x + b
+// Every curve names its own coordinate and scalar types, so the point code
+// is compiled once per curve with that curve's specialized reduction:
+//     Field   coordinates modulo the field prime
+//     Scalar  numbers modulo the group order
+//     A       the a coefficient, a small integer
+//     B       the b coefficient
+//     Gx, Gy  the generator
+//     N       the group order as a field element
+//     NAME    short name, used for file names
+//     GLV     whether (x,y) -> (BETA*x, y) is an endomorphism, acting as
+//             multiplication by LAMBDA (see FieldN::splitLambda)
+// Constants are given as 64 bit words, least significant first.
+#include "FieldP.hpp"
+#include "FieldN.hpp"
+#include "FieldP256.hpp"
+#include "MontgomeryField.hpp"
+
+template <class Curve>
+struct Point
+{
+	typename Curve::Field x;
+	typename Curve::Field y;
+
+	// Constant time conditional move: this = a if flag is 1
+	void cmov(const Point &a, int flag)
+	{
+		x.cmov(a.x, flag);
+		y.cmov(a.y, flag);
+	}
+
+	// Constant time conditional negation (y = -y) if flag is 1
+	void cneg(int flag)
+	{
+		y.cneg(flag);
+	}
+};
+
+// Point in Jacobian coordinates (X:Y:Z), standing for the affine point
+// (X/Z^2, Y/Z^3). Additions and doublings need no inversion; Z = 0 is the
+// point at infinity.
+template <class Curve>
+struct Jacobian
+{
+	typename Curve::Field x;
+	typename Curve::Field y;
+	typename Curve::Field z;
+
+	// Constant time conditional move: this = a if flag is 1
+	void cmov(const Jacobian &a, int flag)
+	{
+		x.cmov(a.x, flag);
+		y.cmov(a.y, flag);
+		z.cmov(a.z, flag);
+	}
+
+	// Constant time conditional negation (y = -y) if flag is 1
+	void cneg(int flag)
+	{
+		y.cneg(flag);
+	}
+};
+
+// Constant time table lookup: return table[idx] for 0 <= idx < len
+// Every entry is read and masked, so neither the branches nor the
+// memory access pattern depend on a secret index
+template <class T>
+T ctLookup(const T *table, int len, int idx)
+{
+	T r = table[0];
+	for (int i=1; i<len; i++)
+		r.cmov(table[i], i == idx);
+	return r;
+}
+
+// secp256k1, used by Bitcoin
+struct Secp256k1
+{
+	typedef FieldP Field;
+	typedef FieldN Scalar;
+	static constexpr const char *NAME = "secp256k1";
+	static constexpr bool GLV = true;
+	static constexpr int A = 0;
+	static constexpr FieldP B = FieldP(7, 0, 0, 0);
+	static constexpr FieldP Gx = FieldP(0x59F2815B16F81798ULL, 0x029BFCDB2DCE28D9ULL, 0x55A06295CE870B07ULL, 0x79BE667EF9DCBBACULL);
+	static constexpr FieldP Gy = FieldP(0x9C47D08FFB10D4B8ULL, 0xFD17B448A6855419ULL, 0x5DA4FBFC0E1108A8ULL, 0x483ADA7726A3C465ULL);
+	static constexpr FieldP N = FieldP(0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL);
+	static constexpr FieldP BETA = FieldP(0xC1396C28719501EEULL, 0x9CF0497512F58995ULL, 0x6E64479EAC3434E9ULL, 0x7AE96A2B657C0710ULL);
+};
+
+// Group order of P-256, a modulus for MontGF
+struct P256Order
+{
+	static constexpr uint64_t p[4] = {0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL,
+	                                  0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL};
+};
+
+// NIST P-256, also known as secp256r1 and prime256v1
+struct P256
+{
+	typedef FieldP256 Field;
+	typedef MontGF<P256Order> Scalar;
+	static constexpr const char *NAME = "p256";
+	static constexpr bool GLV = false;
+	static constexpr int A = -3;
+	static constexpr FieldP256 B = FieldP256(0x3BCE3C3E27D2604BULL, 0x651D06B0CC53B0F6ULL, 0xB3EBBD55769886BCULL, 0x5AC635D8AA3A93E7ULL);
+	static constexpr FieldP256 Gx = FieldP256(0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL);
+	static constexpr FieldP256 Gy = FieldP256(0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL);
+	static constexpr FieldP256 N = FieldP256(0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL);
+};
+#endif
@@ -0,0 +1,456 @@
+#ifndef GUARD_FIELDN
+#define GUARD_FIELDN
+
+// Scalar modulo the secp256k1 group order
+// N = 2^256 - NC, where NC is only 129 bits long, so a 512 bit product is
+// reduced by folding the upper half back with NC until it fits 256 bits.
+// Values are kept fully reduced in four 64 bit limbs (least significant first).
+#include <gmpxx.h>  // mpz_class (bignum)
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "ModInv.hpp"
+#include "Hex.hpp"
+using namespace std;
+
+class FieldN
+{
+private:
+	uint64_t n[4];
+
+	static constexpr uint64_t N[4] = {0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL,
+	                                  0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL};
+	static constexpr uint64_t NC[3] = {0x402DA1732FC9BEBFULL, 0x4551231950B75FC4ULL, 1};
+
+	// N for the safegcd inversion
+	static constexpr ModInv::Info INV_INFO = {{{0x3FD25E8CD0364141LL, 0x2ABB739ABD2280EELL, -0x15LL, 0, 256}},
+	                                          0x34F20099AA774EC1ULL};
+
+	// Return 1 if a >= N, without branching on the value
+	static uint64_t overflow(const uint64_t *a)
+	{
+		uint64_t yes = 0, no = 0;
+		for (int j=3; j>=0; j--)
+		{
+			yes |= (a[j] > N[j]) & (no ^ 1);
+			no  |= (a[j] < N[j]) & (yes ^ 1);
+		}
+		return yes | (no ^ 1);
+	}
+
+	// Subtract N from a if flag is set, a + NC (mod 2^256) is the same thing
+	static void reduce(uint64_t *a, uint64_t flag)
+	{
+		uint64_t mask = -flag;
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)a[j] + ((j < 3 ? NC[j] : 0) & mask);
+			a[j] = (uint64_t)c;
+			c >>= 64;
+		}
+	}
+
+	// r[0..len) += hi * NC, carries are propagated to the end of r
+	static void foldAdd(uint64_t *r, int len, const uint64_t *hi, int hlen)
+	{
+		for (int i=0; i<hlen; i++)
+		{
+			uint128_t c = 0;
+			for (int j=0; j<3; j++)
+			{
+				c += (uint128_t)hi[i] * NC[j] + r[i+j];
+				r[i+j] = (uint64_t)c;
+				c >>= 64;
+			}
+			for (int k=i+3; k<len; k++)
+			{
+				c += r[k];
+				r[k] = (uint64_t)c;
+				c >>= 64;
+			}
+		}
+	}
+
+	// Reduce a 512 bit number l[0..8) modulo N
+	static void reduce512(uint64_t *r, const uint64_t *l)
+	{
+		// 512 bits into 385: m = l[0..4) + l[4..8) * NC
+		uint64_t m[7] = {l[0], l[1], l[2], l[3], 0, 0, 0};
+		foldAdd(m, 7, l+4, 4);
+
+		// 385 bits into 258: p = m[0..4) + m[4..7) * NC
+		uint64_t p[5] = {m[0], m[1], m[2], m[3], 0};
+		foldAdd(p, 5, m+4, 3);
+
+		// 258 bits into 256 plus a carry: t = p[0..4) + p[4] * NC
+		uint64_t t[5] = {p[0], p[1], p[2], p[3], 0};
+		foldAdd(t, 5, p+4, 1);
+
+		// The result is below 2N, so one subtraction is enough
+		reduce(t, t[4] | overflow(t));
+		for (int j=0; j<4; j++)
+			r[j] = t[j];
+	}
+
+	// l = a * b, the full 512 bit product
+	static void product(uint64_t *l, const uint64_t *a, const uint64_t *b)
+	{
+		for (int j=0; j<8; j++)
+			l[j] = 0;
+		for (int i=0; i<4; i++)
+		{
+			uint128_t c = 0;
+			for (int j=0; j<4; j++)
+			{
+				c += (uint128_t)a[i] * b[j] + l[i+j];
+				l[i+j] = (uint64_t)c;
+				c >>= 64;
+			}
+			l[i+4] = (uint64_t)c;
+		}
+	}
+
+	// N as bignum, only needed to convert from arbitrary values
+	static const mpz_class &order()
+	{
+		static const mpz_class p = [] {
+			mpz_class r;
+			mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, N);
+			return r;
+		}();
+		return p;
+	}
+
+	// r = a * b (mod N)
+	static void mul(uint64_t *r, const uint64_t *a, const uint64_t *b)
+	{
+		uint64_t l[8];
+		product(l, a, b);
+		reduce512(r, l);
+	}
+
+public:
+	// Empty constructor
+	FieldN ()
+	{
+		n[0] = n[1] = n[2] = n[3] = 0;
+	}
+
+	// Constructor from small integer
+	FieldN (int v)
+	{
+		n[0] = n[1] = n[2] = n[3] = 0;
+		if (v >= 0)
+			n[0] = v;
+		else
+			*this = -FieldN(-v);
+	}
+
+	// Constructor from bignum
+	FieldN (const mpz_class &v)
+	{
+		mpz_class r;
+		mpz_mod(r.get_mpz_t(), v.get_mpz_t(), order().get_mpz_t());
+		n[0] = n[1] = n[2] = n[3] = 0;
+		mpz_export(n, NULL, -1, sizeof(uint64_t), 0, 0, r.get_mpz_t());
+	}
+
+	// Load a 32 byte big endian number, like a message digest, reduced mod N
+	// Optionally report whether the number was >= N
+	static FieldN fromBytes32(const uint8_t *b, bool *overflowed=NULL)
+	{
+		FieldN r;
+		for (int j=0; j<4; j++)
+		{
+			const uint8_t *w = b + 24 - 8*j;
+			r.n[j] = (uint64_t)w[0] << 56 | (uint64_t)w[1] << 48 | (uint64_t)w[2] << 40 |
+			         (uint64_t)w[3] << 32 | (uint64_t)w[4] << 24 | (uint64_t)w[5] << 16 |
+			         (uint64_t)w[6] << 8  | (uint64_t)w[7];
+		}
+		uint64_t o = overflow(r.n);
+		reduce(r.n, o);
+		if (overflowed)
+			*overflowed = o;
+		return r;
+	}
+
+	// Store as 32 byte big endian number
+	void toBytes32(uint8_t *b) const
+	{
+		for (int j=0; j<4; j++)
+			for (int k=0; k<8; k++)
+				b[31 - 8*j - k] = n[j] >> (8*k);
+	}
+
+	// Write 64 hex digits and a terminating zero to out
+	void toHex(char *out) const
+	{
+		uint8_t b[32];
+		toBytes32(b);
+		hexEncode(out, b, 32);
+	}
+
+	// Return num
+	mpz_class getNum() const
+	{
+		mpz_class r;
+		mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, n);
+		return r;
+	}
+
+	// Return string
+	string toStr(int base=16) const
+	{
+		return getNum().get_str(base) + " (mod N)";
+	}
+
+	// Check if zero
+	bool isZero() const
+	{
+		return (n[0] | n[1] | n[2] | n[3]) == 0;
+	}
+
+	// Check if greater than N/2
+	bool isHigh() const
+	{
+		static const uint64_t H[4] = {0xDFE92F46681B20A0ULL, 0x5D576E7357A4501DULL,
+		                              0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL};
+		uint64_t yes = 0, no = 0;
+		for (int j=3; j>=0; j--)
+		{
+			yes |= (n[j] > H[j]) & (no ^ 1);
+			no  |= (n[j] < H[j]) & (yes ^ 1);
+		}
+		return yes;
+	}
+
+	// Check if equal
+	bool operator==(const FieldN &other) const
+	{
+		return ((n[0] ^ other.n[0]) | (n[1] ^ other.n[1]) |
+				(n[2] ^ other.n[2]) | (n[3] ^ other.n[3])) == 0;
+	}
+
+	// Check if equal with int
+	bool operator==(int v) const
+	{
+		return *this == FieldN(v);
+	}
+
+	// Check if not equal
+	bool operator!=(const FieldN &other) const
+	{
+		return !(*this == other);
+	}
+
+	// Check if not equal with int
+	bool operator!=(int v) const
+	{
+		return !(*this == FieldN(v));
+	}
+
+	// Constant time conditional move: num = a if flag is 1, unchanged if 0
+	void cmov(const FieldN &a, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+			n[j] ^= mask & (n[j] ^ a.n[j]);
+	}
+
+	// Constant time select: a if flag is 0, b if flag is 1
+	static FieldN select(const FieldN &a, const FieldN &b, int flag)
+	{
+		FieldN r = a;
+		r.cmov(b, flag);
+		return r;
+	}
+
+	// Constant time conditional swap of a and b if flag is 1
+	static void cswap(FieldN &a, FieldN &b, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+		{
+			uint64_t t = mask & (a.n[j] ^ b.n[j]);
+			a.n[j] ^= t;
+			b.n[j] ^= t;
+		}
+	}
+
+	// Constant time conditional negation if flag is 1
+	void cneg(int flag)
+	{
+		cmov(-*this, flag);
+	}
+
+	// Define addition
+	FieldN operator+(const FieldN &other) const
+	{
+		FieldN r;
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)n[j] + other.n[j];
+			r.n[j] = (uint64_t)c;
+			c >>= 64;
+		}
+		reduce(r.n, (uint64_t)c | overflow(r.n));
+		return r;
+	}
+
+	// Define negative number
+	FieldN operator-() const
+	{
+		// N - num, or zero if num is zero
+		uint64_t nonzero = -(uint64_t)!isZero();
+		FieldN r;
+		uint128_t c = 1;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)(~n[j]) + N[j];
+			r.n[j] = (uint64_t)c & nonzero;
+			c >>= 64;
+		}
+		return r;
+	}
+
+	// Define subtraction
+	FieldN operator-(const FieldN &other) const
+	{
+		return *this + (-other);
+	}
+
+	// Define multiplication
+	FieldN operator*(const FieldN &other) const
+	{
+		FieldN r;
+		mul(r.n, n, other.n);
+		return r;
+	}
+
+	// a * b + c, the sum is added to the 512 bit product so only one
+	// reduction is done
+	static FieldN mulAdd(const FieldN &a, const FieldN &b, const FieldN &c)
+	{
+		uint64_t l[8];
+		product(l, a.n, b.n);
+
+		// (N-1)^2 + N-1 < 2^512, so the sum cannot overflow l
+		uint128_t carry = 0;
+		for (int j=0; j<8; j++)
+		{
+			carry += (uint128_t)l[j] + (j < 4 ? c.n[j] : 0);
+			l[j] = (uint64_t)carry;
+			carry >>= 64;
+		}
+		FieldN r;
+		reduce512(r.n, l);
+		return r;
+	}
+
+	// a * b - c with one reduction
+	static FieldN mulSub(const FieldN &a, const FieldN &b, const FieldN &c)
+	{
+		return mulAdd(a, b, -c);
+	}
+
+	// Split num into r1 + r2 * LAMBDA (mod N) for the secp256k1 endomorphism
+	// (GLV); r1 and r2, or their negatives, have at most 128 bits.
+	// With c1 = round(num * G1 / 2^384) and c2 = round(num * G2 / 2^384):
+	// r2 = c1 * MB1 + c2 * MB2 and r1 = num - r2 * LAMBDA
+	// See: https://www.iacr.org/archive/crypto2001/21390189.pdf
+	void splitLambda(FieldN &r1, FieldN &r2) const
+	{
+		static const uint64_t LAMBDA[4] = {0xDF02967C1B23BD72ULL, 0x122E22EA20816678ULL,
+		                                   0xA5261C028812645AULL, 0x5363AD4CC05C30E0ULL};
+		static const uint64_t MB1[4] = {0x6F547FA90ABFE4C3ULL, 0xE4437ED6010E8828ULL, 0, 0};
+		static const uint64_t MB2[4] = {0xD765CDA83DB1562CULL, 0x8A280AC50774346DULL,
+		                                0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL};
+		static const uint64_t G1[4] = {0xE893209A45DBB031ULL, 0x3DAA8A1471E8CA7FULL,
+		                               0xE86C90E49284EB15ULL, 0x3086D221A7D46BCDULL};
+		static const uint64_t G2[4] = {0x1571B4AE8AC47F71ULL, 0x221208AC9DF506C6ULL,
+		                               0x6F547FA90ABFE4C4ULL, 0xE4437ED6010E8828ULL};
+
+		// c = round(num * g / 2^384), below 2^128 plus the rounding carry
+		FieldN c1, c2;
+		const uint64_t *g[2] = {G1, G2};
+		FieldN *c[2] = {&c1, &c2};
+		for (int i=0; i<2; i++)
+		{
+			uint64_t l[8];
+			product(l, n, g[i]);
+			uint128_t t = (uint128_t)l[6] + (l[5] >> 63);
+			c[i]->n[0] = (uint64_t)t;
+			t = (t >> 64) + l[7];
+			c[i]->n[1] = (uint64_t)t;
+			c[i]->n[2] = (uint64_t)(t >> 64);
+		}
+
+		FieldN t1, t2, t3;
+		mul(t1.n, c1.n, MB1);
+		mul(t2.n, c2.n, MB2);
+		r2 = t1 + t2;
+		mul(t3.n, r2.n, LAMBDA);
+		r1 = *this - t3;
+	}
+
+	// Define inverse in constant time (inverse of zero is zero)
+	FieldN inv() const
+	{
+		FieldN r;
+		ModInv::Signed62 x = ModInv::fromWords(n);
+		ModInv::inv(x, INV_INFO);
+		ModInv::toWords(r.n, x);
+		return r;
+	}
+
+	// Define inverse in variable time, only for public values
+	FieldN invVar() const
+	{
+		FieldN r;
+		ModInv::Signed62 x = ModInv::fromWords(n);
+		ModInv::invVar(x, INV_INFO);
+		ModInv::toWords(r.n, x);
+		return r;
+	}
+
+	// Define division
+	FieldN operator/(const FieldN &other) const
+	{
+		return *this * other.inv();
+	}
+
+	// Invert len elements at once with Montgomery's trick: one inversion
+	// plus 3*(len-1) multiplications. Zeros are inverted to zero.
+	// r and a must not overlap.
+	static void invAll(FieldN *r, const FieldN *a, size_t len)
+	{
+		if (len == 0)
+			return;
+
+		// r[i] = product of all nonzero a[0..i]
+		FieldN acc(1);
+		for (size_t i=0; i<len; i++)
+		{
+			if (!a[i].isZero())
+				acc = acc * a[i];
+			r[i] = acc;
+		}
+
+		// Walk back, peeling one factor off the inverse at a time
+		FieldN inv = acc.inv();
+		for (size_t i=len-1; i>0; i--)
+		{
+			if (a[i].isZero())
+			{
+				r[i] = 0;
+				continue;
+			}
+			r[i] = r[i-1] * inv;
+			inv = inv * a[i];
+		}
+		r[0] = a[0].isZero() ? FieldN() : inv;
+	}
+};
+#endif
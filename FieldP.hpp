@@ -0,0 +1,669 @@
+#ifndef GUARD_FIELDP
+#define GUARD_FIELDP
+
+// Element of the secp256k1 base field with P = 2^256 - 0x1000003D1
+// The value is kept in five 52 bit limbs (least significant first), so
+// products of two limbs and their sums fit in a 128 bit accumulator.
+// Reduction uses 2^256 = 0x1000003D1 (mod P) instead of a generic division.
+//
+// Additions, negations and small multiples are not reduced: every element
+// carries its magnitude m, a bound meaning each limb is at most 2*m times
+// its normalized maximum. Limbs are only folded back when a multiplication
+// input exceeds MAX_MUL_MAG or a sum exceeds MAX_MAG, and fully reduced
+// when the value is compared or exported.
+#include <gmpxx.h>  // mpz_class (bignum)
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "ModInv.hpp"
+#include "Hex.hpp"
+using namespace std;
+
+class FieldP
+{
+private:
+	uint64_t n[5];
+	int mag;
+
+	static const uint64_t M = 0xFFFFFFFFFFFFFULL;  // 52 bit mask
+	static const uint64_t R = 0x1000003D10ULL;     // 2^260 mod P
+	static const int MAX_MUL_MAG = 8;              // Keeps products in 128 bits
+	static const int MAX_MAG = 32;                 // Keeps limbs in 64 bits
+
+	// P as four 64 bit words
+	static constexpr uint64_t P[4] = {0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL,
+	                                  0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL};
+
+	// P for the safegcd inversion, as 2^256 - 0x1000003D1
+	static constexpr ModInv::Info INV_INFO = {{{-0x1000003D1LL, 0, 0, 0, 256}}, 0x27C7F6E22DDACACFULL};
+
+	// Bring limbs back to [0,P) with 52 bits each (48 for the last one)
+	void normalize()
+	{
+		uint64_t t0 = n[0], t1 = n[1], t2 = n[2], t3 = n[3], t4 = n[4];
+
+		// Fold the bits above 2^256 into the lowest limb
+		uint64_t x = t4 >> 48;
+		t4 &= 0x0FFFFFFFFFFFFULL;
+		t0 += x * 0x1000003D1ULL;
+		t1 += (t0 >> 52); t0 &= M;
+		t2 += (t1 >> 52); t1 &= M; uint64_t m = t1;
+		t3 += (t2 >> 52); t2 &= M; m &= t2;
+		t4 += (t3 >> 52); t3 &= M; m &= t3;
+
+		// Subtract P once more if the value is still >= P
+		x = (t4 >> 48) | ((t4 == 0x0FFFFFFFFFFFFULL) & (m == M) & (t0 >= 0xFFFFEFFFFFC2FULL));
+		t0 += x * 0x1000003D1ULL;
+		t1 += (t0 >> 52); t0 &= M;
+		t2 += (t1 >> 52); t1 &= M;
+		t3 += (t2 >> 52); t2 &= M;
+		t4 += (t3 >> 52); t3 &= M;
+		t4 &= 0x0FFFFFFFFFFFFULL;
+
+		n[0] = t0; n[1] = t1; n[2] = t2; n[3] = t3; n[4] = t4;
+		mag = 1;
+	}
+
+	// Fold the bits above 2^256 back, value ends with magnitude 1 but may be >= P
+	void normalizeWeak()
+	{
+		uint64_t t0 = n[0], t1 = n[1], t2 = n[2], t3 = n[3], t4 = n[4];
+		uint64_t x = t4 >> 48;
+		t4 &= 0x0FFFFFFFFFFFFULL;
+		t0 += x * 0x1000003D1ULL;
+		t1 += (t0 >> 52); t0 &= M;
+		t2 += (t1 >> 52); t1 &= M;
+		t3 += (t2 >> 52); t2 &= M;
+		t4 += (t3 >> 52); t3 &= M;
+		n[0] = t0; n[1] = t1; n[2] = t2; n[3] = t3; n[4] = t4;
+		mag = 1;
+	}
+
+	// Fold back if the magnitude grew past what further additions allow
+	void limitMag()
+	{
+		if (mag > MAX_MAG)
+			normalizeWeak();
+	}
+
+	// Copy that can be used as input of mul() and sqr()
+	FieldP mulInput() const
+	{
+		FieldP r = *this;
+		if (r.mag > MAX_MUL_MAG)
+			r.normalizeWeak();
+		return r;
+	}
+
+	// Fully reduced copy, for comparison and export
+	FieldP normalized() const
+	{
+		FieldP r = *this;
+		r.normalize();
+		return r;
+	}
+
+	// Load from four 64 bit words (least significant first)
+	void setWords(const uint64_t d[4])
+	{
+		n[0] = d[0] & M;
+		n[1] = (d[0] >> 52 | d[1] << 12) & M;
+		n[2] = (d[1] >> 40 | d[2] << 24) & M;
+		n[3] = (d[2] >> 28 | d[3] << 36) & M;
+		n[4] = d[3] >> 16;
+		normalize();
+	}
+
+	// Store as four 64 bit words (least significant first)
+	void getWords(uint64_t d[4]) const
+	{
+		FieldP t = normalized();
+		d[0] = t.n[0]       | t.n[1] << 52;
+		d[1] = t.n[1] >> 12 | t.n[2] << 40;
+		d[2] = t.n[2] >> 24 | t.n[3] << 28;
+		d[3] = t.n[3] >> 36 | t.n[4] << 16;
+	}
+
+	// r = a * b (mod P), inputs up to magnitude 8, output has magnitude 1
+	static void mul(uint64_t *r, const uint64_t *a, const uint64_t *b)
+	{
+		uint128_t c, d;
+		uint64_t t3, t4, tx, u0;
+		uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+
+		// Column 3, plus column 8 folded down by R
+		d  = (uint128_t)a0 * b[3] + (uint128_t)a1 * b[2] + (uint128_t)a2 * b[1] + (uint128_t)a3 * b[0];
+		c  = (uint128_t)a4 * b[4];
+		d += (uint128_t)R * (uint64_t)c; c >>= 64;
+		t3 = d & M; d >>= 52;
+
+		// Column 4
+		d += (uint128_t)a0 * b[4] + (uint128_t)a1 * b[3] + (uint128_t)a2 * b[2] + (uint128_t)a3 * b[1] + (uint128_t)a4 * b[0];
+		d += (uint128_t)(R << 12) * (uint64_t)c;
+		t4 = d & M; d >>= 52;
+		tx = (t4 >> 48); t4 &= (M >> 4);
+
+		// Column 0, plus column 5 folded down
+		c  = (uint128_t)a0 * b[0];
+		d += (uint128_t)a1 * b[4] + (uint128_t)a2 * b[3] + (uint128_t)a3 * b[2] + (uint128_t)a4 * b[1];
+		u0 = d & M; d >>= 52;
+		u0 = (u0 << 4) | tx;
+		c += (uint128_t)u0 * (R >> 4);
+		r[0] = c & M; c >>= 52;
+
+		// Column 1, plus column 6 folded down
+		c += (uint128_t)a0 * b[1] + (uint128_t)a1 * b[0];
+		d += (uint128_t)a2 * b[4] + (uint128_t)a3 * b[3] + (uint128_t)a4 * b[2];
+		c += (uint128_t)(d & M) * R; d >>= 52;
+		r[1] = c & M; c >>= 52;
+
+		// Column 2, plus column 7 folded down
+		c += (uint128_t)a0 * b[2] + (uint128_t)a1 * b[1] + (uint128_t)a2 * b[0];
+		d += (uint128_t)a3 * b[4] + (uint128_t)a4 * b[3];
+		c += (uint128_t)R * (uint64_t)d; d >>= 64;
+		r[2] = c & M; c >>= 52;
+
+		// Remaining carries into columns 3 and 4
+		c += (uint128_t)(R << 12) * (uint64_t)d + t3;
+		r[3] = c & M; c >>= 52;
+		c += t4;
+		r[4] = c;
+	}
+
+	// r = a^2 (mod P), same bounds as mul(), the cross products a[i]*a[j] are computed once and doubled
+	static void sqr(uint64_t *r, const uint64_t *a)
+	{
+		uint128_t c, d;
+		uint64_t t3, t4, tx, u0;
+		uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+
+		// Column 3, plus column 8 folded down by R
+		d  = (uint128_t)(a0*2) * a3 + (uint128_t)(a1*2) * a2;
+		c  = (uint128_t)a4 * a4;
+		d += (uint128_t)R * (uint64_t)c; c >>= 64;
+		t3 = d & M; d >>= 52;
+
+		// Column 4
+		a4 *= 2;
+		d += (uint128_t)a0 * a4 + (uint128_t)(a1*2) * a3 + (uint128_t)a2 * a2;
+		d += (uint128_t)(R << 12) * (uint64_t)c;
+		t4 = d & M; d >>= 52;
+		tx = (t4 >> 48); t4 &= (M >> 4);
+
+		// Column 0, plus column 5 folded down
+		c  = (uint128_t)a0 * a0;
+		d += (uint128_t)a1 * a4 + (uint128_t)(a2*2) * a3;
+		u0 = d & M; d >>= 52;
+		u0 = (u0 << 4) | tx;
+		c += (uint128_t)u0 * (R >> 4);
+		r[0] = c & M; c >>= 52;
+
+		// Column 1, plus column 6 folded down
+		a0 *= 2;
+		c += (uint128_t)a0 * a1;
+		d += (uint128_t)a2 * a4 + (uint128_t)a3 * a3;
+		c += (uint128_t)(d & M) * R; d >>= 52;
+		r[1] = c & M; c >>= 52;
+
+		// Column 2, plus column 7 folded down
+		c += (uint128_t)a0 * a2 + (uint128_t)a1 * a1;
+		d += (uint128_t)a3 * a4;
+		c += (uint128_t)R * (uint64_t)d; d >>= 64;
+		r[2] = c & M; c >>= 52;
+
+		// Remaining carries into columns 3 and 4
+		c += (uint128_t)(R << 12) * (uint64_t)d + t3;
+		r[3] = c & M; c >>= 52;
+		c += t4;
+		r[4] = c;
+	}
+
+	// Square k times in a row
+	FieldP sqrN(int k) const
+	{
+		FieldP r = mulInput();
+		for (int i=0; i<k; i++)
+			sqr(r.n, r.n);
+		r.mag = 1;
+		return r;
+	}
+
+	// num^((P-3)/4) by a fixed addition chain: 253 squarings, 14 multiplications
+	// The exponent in binary is 223 ones, a zero, 22 ones and 00001011, so the
+	// chain builds num^(2^k-1) for the block lengths k = 2, 3, 22 and 223.
+	FieldP powChain() const
+	{
+		const FieldP &a = *this;
+		FieldP x2 = a.sqr() * a;
+		FieldP x3 = x2.sqr() * a;
+		FieldP x6 = x3.sqrN(3) * x3;
+		FieldP x9 = x6.sqrN(3) * x3;
+		FieldP x11 = x9.sqrN(2) * x2;
+		FieldP x22 = x11.sqrN(11) * x11;
+		FieldP x44 = x22.sqrN(22) * x22;
+		FieldP x88 = x44.sqrN(44) * x44;
+		FieldP x176 = x88.sqrN(88) * x88;
+		FieldP x220 = x176.sqrN(44) * x44;
+		FieldP x223 = x220.sqrN(3) * x3;
+		FieldP t = x223.sqrN(23) * x22;
+		t = t.sqrN(5) * a;
+		return t.sqrN(3) * x2;
+	}
+
+	// Raise to a 256 bit exponent given as four 64 bit words
+	FieldP powWords(const uint64_t e[4]) const
+	{
+		// Skip leading zero bits, so small exponents cost a few operations
+		int i = 255;
+		while (i >= 0 && ((e[i/64] >> (i%64)) & 1) == 0)
+			i--;
+		FieldP r(1);
+		for (; i>=0; i--)
+		{
+			r = r.sqr();
+			if ((e[i/64] >> (i%64)) & 1)
+				r = r * *this;
+		}
+		return r;
+	}
+
+	// Modulus as bignum, only needed to convert from arbitrary values
+	static const mpz_class &prime()
+	{
+		static const mpz_class p = [] {
+			mpz_class r;
+			mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, P);
+			return r;
+		}();
+		return p;
+	}
+
+public:
+	// Empty constructor
+	FieldP ()
+	{
+		n[0] = n[1] = n[2] = n[3] = n[4] = 0;
+		mag = 1;
+	}
+
+	// Constructor from small integer
+	FieldP (int v)
+	{
+		n[0] = n[1] = n[2] = n[3] = n[4] = 0;
+		mag = 1;
+		if (v >= 0)
+			n[0] = v;
+		else
+			*this = -FieldP(-v);
+	}
+
+	// Constructor from four 64 bit words of a number below P (least
+	// significant first), evaluated by the compiler for constants
+	constexpr FieldP (uint64_t d0, uint64_t d1, uint64_t d2, uint64_t d3)
+		: n{d0 & M, (d0 >> 52 | d1 << 12) & M, (d1 >> 40 | d2 << 24) & M,
+		    (d2 >> 28 | d3 << 36) & M, d3 >> 16}, mag(1)
+	{
+	}
+
+	// Constructor from bignum
+	FieldP (const mpz_class &v)
+	{
+		mpz_class r;
+		mpz_mod(r.get_mpz_t(), v.get_mpz_t(), prime().get_mpz_t());
+		uint64_t d[4] = {0, 0, 0, 0};
+		mpz_export(d, NULL, -1, sizeof(uint64_t), 0, 0, r.get_mpz_t());
+		setWords(d);
+	}
+
+	// Load a 32 byte big endian number, reduced mod P
+	// Optionally report whether the number was >= P
+	static FieldP fromBytes32(const uint8_t *b, bool *overflowed=NULL)
+	{
+		uint64_t d[4];
+		for (int j=0; j<4; j++)
+		{
+			const uint8_t *w = b + 24 - 8*j;
+			d[j] = (uint64_t)w[0] << 56 | (uint64_t)w[1] << 48 | (uint64_t)w[2] << 40 |
+			       (uint64_t)w[3] << 32 | (uint64_t)w[4] << 24 | (uint64_t)w[5] << 16 |
+			       (uint64_t)w[6] << 8  | (uint64_t)w[7];
+		}
+		if (overflowed)
+			*overflowed = (d[3] & d[2] & d[1]) == UINT64_MAX && d[0] >= 0xFFFFFFFEFFFFFC2FULL;
+		FieldP r;
+		r.setWords(d);
+		return r;
+	}
+
+	// Store as 32 byte big endian number
+	void toBytes32(uint8_t *b) const
+	{
+		uint64_t d[4];
+		getWords(d);
+		for (int j=0; j<4; j++)
+			for (int k=0; k<8; k++)
+				b[31 - 8*j - k] = d[j] >> (8*k);
+	}
+
+	// Write 64 hex digits and a terminating zero to out
+	void toHex(char *out) const
+	{
+		uint8_t b[32];
+		toBytes32(b);
+		hexEncode(out, b, 32);
+	}
+
+	// Return num
+	mpz_class getNum() const
+	{
+		uint64_t d[4];
+		getWords(d);
+		mpz_class r;
+		mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, d);
+		return r;
+	}
+
+	// Return string
+	string toStr(int base=16) const
+	{
+		return getNum().get_str(base) + " (mod P)";
+	}
+
+	// Check if zero
+	bool isZero() const
+	{
+		FieldP t = normalized();
+		return (t.n[0] | t.n[1] | t.n[2] | t.n[3] | t.n[4]) == 0;
+	}
+
+	// Check if value is odd
+	bool isOdd() const
+	{
+		return normalized().n[0] & 1;
+	}
+
+	// Check if equal
+	bool operator==(const FieldP &other) const
+	{
+		FieldP a = normalized(), b = other.normalized();
+		return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) | (a.n[2] ^ b.n[2]) |
+				(a.n[3] ^ b.n[3]) | (a.n[4] ^ b.n[4])) == 0;
+	}
+
+	// Check if equal with int
+	bool operator==(int v) const
+	{
+		return *this == FieldP(v);
+	}
+
+	// Check if not equal
+	bool operator!=(const FieldP &other) const
+	{
+		return !(*this == other);
+	}
+
+	// Check if not equal with int
+	bool operator!=(int v) const
+	{
+		return !(*this == FieldP(v));
+	}
+
+	// Constant time conditional move: num = a if flag is 1, unchanged if 0
+	// The magnitude becomes the larger one, it does not depend on flag
+	void cmov(const FieldP &a, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<5; j++)
+			n[j] ^= mask & (n[j] ^ a.n[j]);
+		mag = mag > a.mag ? mag : a.mag;
+	}
+
+	// Constant time select: a if flag is 0, b if flag is 1
+	static FieldP select(const FieldP &a, const FieldP &b, int flag)
+	{
+		FieldP r = a;
+		r.cmov(b, flag);
+		return r;
+	}
+
+	// Constant time conditional swap of a and b if flag is 1
+	static void cswap(FieldP &a, FieldP &b, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<5; j++)
+		{
+			uint64_t t = mask & (a.n[j] ^ b.n[j]);
+			a.n[j] ^= t;
+			b.n[j] ^= t;
+		}
+		int m = a.mag > b.mag ? a.mag : b.mag;
+		a.mag = b.mag = m;
+	}
+
+	// Constant time conditional negation if flag is 1
+	void cneg(int flag)
+	{
+		cmov(-*this, flag);
+	}
+
+	// Define addition
+	FieldP operator+(const FieldP &other) const
+	{
+		FieldP r;
+		for (int i=0; i<5; i++)
+			r.n[i] = n[i] + other.n[i];
+		r.mag = mag + other.mag;
+		r.limitMag();
+		return r;
+	}
+
+	// Define addition with int
+	FieldP operator+(int v) const
+	{
+		return *this + FieldP(v);
+	}
+
+	// Define negative number
+	FieldP operator-() const
+	{
+		// 2*(m+1)*P - num, limb by limb, cannot underflow for magnitude m
+		uint64_t k = 2 * (mag + 1);
+		FieldP r;
+		r.n[0] = 0xFFFFEFFFFFC2FULL * k - n[0];
+		r.n[1] = 0xFFFFFFFFFFFFFULL * k - n[1];
+		r.n[2] = 0xFFFFFFFFFFFFFULL * k - n[2];
+		r.n[3] = 0xFFFFFFFFFFFFFULL * k - n[3];
+		r.n[4] = 0x0FFFFFFFFFFFFULL * k - n[4];
+		r.mag = mag + 1;
+		r.limitMag();
+		return r;
+	}
+
+	// Define subtraction
+	FieldP operator-(const FieldP &other) const
+	{
+		return *this + (-other);
+	}
+
+	// Define subtraction with int
+	FieldP operator-(int v) const
+	{
+		return *this - FieldP(v);
+	}
+
+	// Define multiplication
+	FieldP operator*(const FieldP &other) const
+	{
+		FieldP a = mulInput(), b = other.mulInput();
+		FieldP r;
+		mul(r.n, a.n, b.n);
+		return r;
+	}
+
+	// Define square
+	FieldP sqr() const
+	{
+		FieldP a = mulInput();
+		FieldP r;
+		sqr(r.n, a.n);
+		return r;
+	}
+
+	// a * b + c, c is added to the weakly reduced product without another reduction
+	static FieldP mulAdd(const FieldP &a, const FieldP &b, const FieldP &c)
+	{
+		FieldP x = a.mulInput(), y = b.mulInput();
+		FieldP r;
+		mul(r.n, x.n, y.n);
+		for (int i=0; i<5; i++)
+			r.n[i] += c.n[i];
+		r.mag = 1 + c.mag;
+		r.limitMag();
+		return r;
+	}
+
+	// a * b - c, with 2*(m+1)*P - c added to the product like in negation
+	static FieldP mulSub(const FieldP &a, const FieldP &b, const FieldP &c)
+	{
+		FieldP x = a.mulInput(), y = b.mulInput();
+		FieldP r;
+		mul(r.n, x.n, y.n);
+		uint64_t k = 2 * (c.mag + 1);
+		r.n[0] += 0xFFFFEFFFFFC2FULL * k - c.n[0];
+		r.n[1] += 0xFFFFFFFFFFFFFULL * k - c.n[1];
+		r.n[2] += 0xFFFFFFFFFFFFFULL * k - c.n[2];
+		r.n[3] += 0xFFFFFFFFFFFFFULL * k - c.n[3];
+		r.n[4] += 0x0FFFFFFFFFFFFULL * k - c.n[4];
+		r.mag = 1 + c.mag + 1;
+		r.limitMag();
+		return r;
+	}
+
+	// Define multiplication with int
+	FieldP operator*(int v) const
+	{
+		// Small multiples just scale the limbs and the magnitude
+		if (v > 0 && v <= MAX_MAG)
+		{
+			FieldP r;
+			for (int i=0; i<5; i++)
+				r.n[i] = n[i] * v;
+			r.mag = mag * v;
+			r.limitMag();
+			return r;
+		}
+		return *this * FieldP(v);
+	}
+
+	// Define exponentiation
+	FieldP pow(const mpz_class &exp) const
+	{
+		// Adjust exponent to also takes care of negative values
+		static const mpz_class P1 = prime() - 1;
+		mpz_class e;
+		mpz_mod(e.get_mpz_t(), exp.get_mpz_t(), P1.get_mpz_t());
+		uint64_t d[4] = {0, 0, 0, 0};
+		mpz_export(d, NULL, -1, sizeof(uint64_t), 0, 0, e.get_mpz_t());
+		return powWords(d);
+	}
+
+	// Define exponentiation with int
+	FieldP pow(int e) const
+	{
+		return pow(mpz_class(e));
+	}
+
+	// Square root, num^((P+1)/4) since P = 3 (mod 4)
+	// Return false if num is not a square, root is then meaningless
+	bool sqrt(FieldP &root) const
+	{
+		root = powChain() * *this;
+		return root.sqr() == *this;
+	}
+
+	// Jacobi symbol (num/P) in variable time, only for public values:
+	// 1 for a nonzero square, -1 for a non-square, 0 for zero
+	int jacobiVar() const
+	{
+		uint64_t d[4];
+		getWords(d);
+		if ((d[0] | d[1] | d[2] | d[3]) == 0)
+			return 0;
+		int j = ModInv::jacobiVar(ModInv::fromWords(d), INV_INFO);
+		if (j != 0)
+			return j;
+
+		// Not decided in time (never seen in practice), use Euler's criterion
+		return powChain().sqr() * *this == 1 ? 1 : -1;
+	}
+
+	// Define inverse in constant time (inverse of zero is zero)
+	FieldP inv() const
+	{
+		uint64_t d[4];
+		getWords(d);
+		ModInv::Signed62 x = ModInv::fromWords(d);
+		ModInv::inv(x, INV_INFO);
+		ModInv::toWords(d, x);
+		FieldP r;
+		r.setWords(d);
+		return r;
+	}
+
+	// Define inverse in variable time, only for public values
+	FieldP invVar() const
+	{
+		uint64_t d[4];
+		getWords(d);
+		ModInv::Signed62 x = ModInv::fromWords(d);
+		ModInv::invVar(x, INV_INFO);
+		ModInv::toWords(d, x);
+		FieldP r;
+		r.setWords(d);
+		return r;
+	}
+
+	// Define division
+	FieldP operator/(const FieldP &other) const
+	{
+		return *this * other.inv();
+	}
+
+	// Invert len elements at once with Montgomery's trick: one inversion
+	// plus 3*(len-1) multiplications. Zeros are inverted to zero.
+	// r and a must not overlap.
+	static void invAll(FieldP *r, const FieldP *a, size_t len)
+	{
+		if (len == 0)
+			return;
+
+		// r[i] = product of all nonzero a[0..i]
+		FieldP acc(1);
+		for (size_t i=0; i<len; i++)
+		{
+			if (!a[i].isZero())
+				acc = acc * a[i];
+			r[i] = acc;
+		}
+
+		// Walk back, peeling one factor off the inverse at a time
+		FieldP inv = acc.inv();
+		for (size_t i=len-1; i>0; i--)
+		{
+			if (a[i].isZero())
+			{
+				r[i] = 0;
+				continue;
+			}
+			r[i] = r[i-1] * inv;
+			inv = inv * a[i];
+		}
+		r[0] = a[0].isZero() ? FieldP() : inv;
+	}
+
+	// Define division with int
+	FieldP operator/(int v) const
+	{
+		return *this / FieldP(v);
+	}
+};
+#endif
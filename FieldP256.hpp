@@ -0,0 +1,477 @@
+#ifndef GUARD_FIELDP256
+#define GUARD_FIELDP256
+
+// Element of the NIST P-256 base field, P = 2^256 - 2^224 + 2^192 + 2^96 - 1
+// Values are kept fully reduced in four 64 bit limbs (least significant first).
+// Products are reduced by the Solinas method (FIPS 186-4, D.2.3): P is a sum
+// of powers of 2^32, so the upper half of a 512 bit product folds back onto
+// the lower half by adding and subtracting its 32 bit words in a fixed pattern.
+#include <gmpxx.h>  // mpz_class (bignum)
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "ModInv.hpp"
+#include "Hex.hpp"
+using namespace std;
+
+class FieldP256
+{
+private:
+	uint64_t n[4];
+
+	static constexpr uint64_t P[4] = {0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL,
+	                                  0x0000000000000000ULL, 0xFFFFFFFF00000001ULL};
+	static constexpr uint64_t PC[4] = {0x0000000000000001ULL, 0xFFFFFFFF00000000ULL,  // 2^256 - P
+	                                   0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFEULL};
+
+	// P for the safegcd inversion
+	static constexpr ModInv::Info INV_INFO = ModInv::makeInfo(P);
+
+	// Return 1 if a >= P, without branching on the value
+	static uint64_t overflow(const uint64_t *a)
+	{
+		uint64_t yes = 0, no = 0;
+		for (int j=3; j>=0; j--)
+		{
+			yes |= (a[j] > P[j]) & (no ^ 1);
+			no  |= (a[j] < P[j]) & (yes ^ 1);
+		}
+		return yes | (no ^ 1);
+	}
+
+	// Subtract P from a if flag is set, a + PC (mod 2^256) is the same thing
+	static void reduce(uint64_t *a, uint64_t flag)
+	{
+		uint64_t mask = -flag;
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)a[j] + (PC[j] & mask);
+			a[j] = (uint64_t)c;
+			c >>= 64;
+		}
+	}
+
+	// Propagate signed carries through eight 32 bit words, return the carry out
+	static int64_t carry32(int64_t *w)
+	{
+		for (int j=0; j<7; j++)
+		{
+			w[j+1] += w[j] >> 32;
+			w[j] &= 0xFFFFFFFF;
+		}
+		int64_t top = w[7] >> 32;
+		w[7] &= 0xFFFFFFFF;
+		return top;
+	}
+
+	// Reduce a 512 bit number l[0..8) modulo P
+	static void reduce512(uint64_t *r, const uint64_t *l)
+	{
+		int64_t c[16];
+		for (int j=0; j<8; j++)
+		{
+			c[2*j] = l[j] & 0xFFFFFFFF;
+			c[2*j+1] = l[j] >> 32;
+		}
+
+		// s1 + 2*s2 + 2*s3 + s4 + s5 - s6 - s7 - s8 - s9, word by word
+		int64_t w[8];
+		w[0] = c[0] + c[8]  + c[9]  - c[11] - c[12] - c[13] - c[14];
+		w[1] = c[1] + c[9]  + c[10] - c[12] - c[13] - c[14] - c[15];
+		w[2] = c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+		w[3] = c[3] + 2*c[11] + 2*c[12] + c[13] - c[15] - c[8] - c[9];
+		w[4] = c[4] + 2*c[12] + 2*c[13] + c[14] - c[9] - c[10];
+		w[5] = c[5] + 2*c[13] + 2*c[14] + c[15] - c[10] - c[11];
+		w[6] = c[6] + 3*c[14] + 2*c[15] + c[13] - c[8] - c[9];
+		w[7] = c[7] + 3*c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+
+		// The sum is in (-4*2^256, 7*2^256). Fold the carry with
+		// 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod P); after two folds the
+		// value is in [0,2^256) and one subtraction of P is enough.
+		for (int i=0; i<2; i++)
+		{
+			int64_t top = carry32(w);
+			w[0] += top;
+			w[3] -= top;
+			w[6] -= top;
+			w[7] += top;
+		}
+		carry32(w);
+		for (int j=0; j<4; j++)
+			r[j] = (uint64_t)w[2*j] | (uint64_t)w[2*j+1] << 32;
+		reduce(r, overflow(r));
+	}
+
+	// l = a * b, the full 512 bit product
+	static void product(uint64_t *l, const uint64_t *a, const uint64_t *b)
+	{
+		for (int j=0; j<8; j++)
+			l[j] = 0;
+		for (int i=0; i<4; i++)
+		{
+			uint128_t c = 0;
+			for (int j=0; j<4; j++)
+			{
+				c += (uint128_t)a[i] * b[j] + l[i+j];
+				l[i+j] = (uint64_t)c;
+				c >>= 64;
+			}
+			l[i+4] = (uint64_t)c;
+		}
+	}
+
+	// Raise to a 256 bit exponent given as four 64 bit words
+	FieldP256 powWords(const uint64_t e[4]) const
+	{
+		// Skip leading zero bits, so small exponents cost a few operations
+		int i = 255;
+		while (i >= 0 && ((e[i/64] >> (i%64)) & 1) == 0)
+			i--;
+		FieldP256 r(1);
+		for (; i>=0; i--)
+		{
+			r = r.sqr();
+			if ((e[i/64] >> (i%64)) & 1)
+				r = r * *this;
+		}
+		return r;
+	}
+
+	// Modulus as bignum, only needed to convert from arbitrary values
+	static const mpz_class &prime()
+	{
+		static const mpz_class p = [] {
+			mpz_class r;
+			mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, P);
+			return r;
+		}();
+		return p;
+	}
+
+public:
+	// Empty constructor
+	FieldP256 ()
+	{
+		n[0] = n[1] = n[2] = n[3] = 0;
+	}
+
+	// Constructor from small integer
+	FieldP256 (int v)
+	{
+		n[0] = n[1] = n[2] = n[3] = 0;
+		if (v >= 0)
+			n[0] = v;
+		else
+			*this = -FieldP256(-v);
+	}
+
+	// Constructor from four 64 bit words of a number below P (least
+	// significant first), evaluated by the compiler for constants
+	constexpr FieldP256 (uint64_t d0, uint64_t d1, uint64_t d2, uint64_t d3)
+		: n{d0, d1, d2, d3}
+	{
+	}
+
+	// Constructor from bignum
+	FieldP256 (const mpz_class &v)
+	{
+		mpz_class r;
+		mpz_mod(r.get_mpz_t(), v.get_mpz_t(), prime().get_mpz_t());
+		n[0] = n[1] = n[2] = n[3] = 0;
+		mpz_export(n, NULL, -1, sizeof(uint64_t), 0, 0, r.get_mpz_t());
+	}
+
+	// Load a 32 byte big endian number, reduced mod P
+	// Optionally report whether the number was >= P
+	static FieldP256 fromBytes32(const uint8_t *b, bool *overflowed=NULL)
+	{
+		FieldP256 r;
+		for (int j=0; j<4; j++)
+		{
+			const uint8_t *w = b + 24 - 8*j;
+			r.n[j] = (uint64_t)w[0] << 56 | (uint64_t)w[1] << 48 | (uint64_t)w[2] << 40 |
+			         (uint64_t)w[3] << 32 | (uint64_t)w[4] << 24 | (uint64_t)w[5] << 16 |
+			         (uint64_t)w[6] << 8  | (uint64_t)w[7];
+		}
+		uint64_t o = overflow(r.n);
+		reduce(r.n, o);
+		if (overflowed)
+			*overflowed = o;
+		return r;
+	}
+
+	// Store as 32 byte big endian number
+	void toBytes32(uint8_t *b) const
+	{
+		for (int j=0; j<4; j++)
+			for (int k=0; k<8; k++)
+				b[31 - 8*j - k] = n[j] >> (8*k);
+	}
+
+	// Write 64 hex digits and a terminating zero to out
+	void toHex(char *out) const
+	{
+		uint8_t b[32];
+		toBytes32(b);
+		hexEncode(out, b, 32);
+	}
+
+	// Return num
+	mpz_class getNum() const
+	{
+		mpz_class r;
+		mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, n);
+		return r;
+	}
+
+	// Return string
+	string toStr(int base=16) const
+	{
+		return getNum().get_str(base) + " (mod P256)";
+	}
+
+	// Check if zero
+	bool isZero() const
+	{
+		return (n[0] | n[1] | n[2] | n[3]) == 0;
+	}
+
+	// Check if value is odd
+	bool isOdd() const
+	{
+		return n[0] & 1;
+	}
+
+	// Check if equal
+	bool operator==(const FieldP256 &other) const
+	{
+		return ((n[0] ^ other.n[0]) | (n[1] ^ other.n[1]) |
+				(n[2] ^ other.n[2]) | (n[3] ^ other.n[3])) == 0;
+	}
+
+	// Check if equal with int
+	bool operator==(int v) const
+	{
+		return *this == FieldP256(v);
+	}
+
+	// Check if not equal
+	bool operator!=(const FieldP256 &other) const
+	{
+		return !(*this == other);
+	}
+
+	// Check if not equal with int
+	bool operator!=(int v) const
+	{
+		return !(*this == FieldP256(v));
+	}
+
+	// Constant time conditional move: num = a if flag is 1, unchanged if 0
+	void cmov(const FieldP256 &a, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+			n[j] ^= mask & (n[j] ^ a.n[j]);
+	}
+
+	// Constant time select: a if flag is 0, b if flag is 1
+	static FieldP256 select(const FieldP256 &a, const FieldP256 &b, int flag)
+	{
+		FieldP256 r = a;
+		r.cmov(b, flag);
+		return r;
+	}
+
+	// Constant time conditional swap of a and b if flag is 1
+	static void cswap(FieldP256 &a, FieldP256 &b, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+		{
+			uint64_t t = mask & (a.n[j] ^ b.n[j]);
+			a.n[j] ^= t;
+			b.n[j] ^= t;
+		}
+	}
+
+	// Constant time conditional negation if flag is 1
+	void cneg(int flag)
+	{
+		cmov(-*this, flag);
+	}
+
+	// Define addition
+	FieldP256 operator+(const FieldP256 &other) const
+	{
+		FieldP256 r;
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)n[j] + other.n[j];
+			r.n[j] = (uint64_t)c;
+			c >>= 64;
+		}
+		reduce(r.n, (uint64_t)c | overflow(r.n));
+		return r;
+	}
+
+	// Define addition with int
+	FieldP256 operator+(int v) const
+	{
+		return *this + FieldP256(v);
+	}
+
+	// Define negative number
+	FieldP256 operator-() const
+	{
+		// P - num, or zero if num is zero
+		uint64_t nonzero = -(uint64_t)!isZero();
+		FieldP256 r;
+		uint128_t c = 1;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)(~n[j]) + P[j];
+			r.n[j] = (uint64_t)c & nonzero;
+			c >>= 64;
+		}
+		return r;
+	}
+
+	// Define subtraction
+	FieldP256 operator-(const FieldP256 &other) const
+	{
+		return *this + (-other);
+	}
+
+	// Define subtraction with int
+	FieldP256 operator-(int v) const
+	{
+		return *this - FieldP256(v);
+	}
+
+	// Define multiplication
+	FieldP256 operator*(const FieldP256 &other) const
+	{
+		uint64_t l[8];
+		product(l, n, other.n);
+		FieldP256 r;
+		reduce512(r.n, l);
+		return r;
+	}
+
+	// Define multiplication with int
+	FieldP256 operator*(int v) const
+	{
+		return *this * FieldP256(v);
+	}
+
+	// Define square
+	FieldP256 sqr() const
+	{
+		return *this * *this;
+	}
+
+	// a * b + c
+	static FieldP256 mulAdd(const FieldP256 &a, const FieldP256 &b, const FieldP256 &c)
+	{
+		return a * b + c;
+	}
+
+	// a * b - c
+	static FieldP256 mulSub(const FieldP256 &a, const FieldP256 &b, const FieldP256 &c)
+	{
+		return a * b - c;
+	}
+
+	// Square root, num^((P+1)/4) since P = 3 (mod 4)
+	// Return false if num is not a square, root is then meaningless
+	bool sqrt(FieldP256 &root) const
+	{
+		static const uint64_t E[4] = {0x0000000000000000ULL, 0x0000000040000000ULL,
+		                              0x4000000000000000ULL, 0x3FFFFFFFC0000000ULL};
+		root = powWords(E);
+		return root.sqr() == *this;
+	}
+
+	// Jacobi symbol (num/P) in variable time, only for public values:
+	// 1 for a nonzero square, -1 for a non-square, 0 for zero
+	int jacobiVar() const
+	{
+		if (isZero())
+			return 0;
+		int j = ModInv::jacobiVar(ModInv::fromWords(n), INV_INFO);
+		if (j != 0)
+			return j;
+
+		// Not decided in time (never seen in practice), check the root
+		FieldP256 root;
+		return sqrt(root) ? 1 : -1;
+	}
+
+	// Define inverse in constant time (inverse of zero is zero)
+	FieldP256 inv() const
+	{
+		FieldP256 r;
+		ModInv::Signed62 x = ModInv::fromWords(n);
+		ModInv::inv(x, INV_INFO);
+		ModInv::toWords(r.n, x);
+		return r;
+	}
+
+	// Define inverse in variable time, only for public values
+	FieldP256 invVar() const
+	{
+		FieldP256 r;
+		ModInv::Signed62 x = ModInv::fromWords(n);
+		ModInv::invVar(x, INV_INFO);
+		ModInv::toWords(r.n, x);
+		return r;
+	}
+
+	// Define division
+	FieldP256 operator/(const FieldP256 &other) const
+	{
+		return *this * other.inv();
+	}
+
+	// Invert len elements at once with Montgomery's trick: one inversion
+	// plus 3*(len-1) multiplications. Zeros are inverted to zero.
+	// r and a must not overlap.
+	static void invAll(FieldP256 *r, const FieldP256 *a, size_t len)
+	{
+		if (len == 0)
+			return;
+
+		// r[i] = product of all nonzero a[0..i]
+		FieldP256 acc(1);
+		for (size_t i=0; i<len; i++)
+		{
+			if (!a[i].isZero())
+				acc = acc * a[i];
+			r[i] = acc;
+		}
+
+		// Walk back, peeling one factor off the inverse at a time
+		FieldP256 inv = acc.inv();
+		for (size_t i=len-1; i>0; i--)
+		{
+			if (a[i].isZero())
+			{
+				r[i] = 0;
+				continue;
+			}
+			r[i] = r[i-1] * inv;
+			inv = inv * a[i];
+		}
+		r[0] = a[0].isZero() ? FieldP256() : inv;
+	}
+
+	// Define division with int
+	FieldP256 operator/(int v) const
+	{
+		return *this / FieldP256(v);
+	}
+};
+#endif
@@ -0,0 +1,263 @@
+#ifndef GUARD_GENTABLEMAP
+#define GUARD_GENTABLEMAP
+
+// Comb table of the generator kept in a file, for a chosen window size
+// The file <NAME>.gentable of the working directory is mapped read-only on
+// first use, so all processes using it share the same pages. After a
+// Header come ceil(256/w) rows of 2^(w-1) affine points, each as eight
+// 64 bit words (x then y, least significant first) in the byte order of
+// the machine that wrote it:
+//     row i, entry j = (2*j+1) * 2^(w*i) * G
+// The rows take 16 KB for w = 2, 32 KB for w = 4 and 32 MB for w = 16,
+// after a 32 byte header. Secret lookups scan a whole row, so signing
+// only uses tables up to COMB_SECRET_WINDOW (6) bits. Public lookups read
+// one entry; going from the built-in table to w = 16 saves about 15 us
+// per multiplication, little next to the start-up of a process.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include "PointOps.hpp"
+using namespace std;
+
+template <class C>
+class GenTableMap
+{
+private:
+	struct Header
+	{
+		char magic[8];       // MAGIC, not terminated
+		char curve[16];      // C::NAME
+		uint32_t window;     // Bits per digit
+		uint32_t positions;  // Number of rows
+	};
+
+	static constexpr char MAGIC[9] = "ECGTABL3";
+
+	// Entries checked on load, spread over the table
+	static const int SAMPLES = 16;
+
+	const uint64_t *data;
+	int w;
+	int entries;
+
+	GenTableMap(const Header *h)
+		: data((const uint64_t *)(h + 1)), w(h->window), entries(1 << (h->window - 1))
+	{
+	}
+
+	// Store a coordinate as four 64 bit words
+	static void getWords(uint64_t *d, const typename C::Field &v)
+	{
+		uint8_t b[32];
+		v.toBytes32(b);
+		for (int j=0; j<4; j++)
+		{
+			d[j] = 0;
+			for (int k=0; k<8; k++)
+				d[j] |= (uint64_t)b[31 - 8*j - k] << (8*k);
+		}
+	}
+
+	// Point from eight 64 bit words
+	static Point<C> fromWords(const uint64_t *d)
+	{
+		return Point<C>{typename C::Field(d[0], d[1], d[2], d[3]),
+		                typename C::Field(d[4], d[5], d[6], d[7])};
+	}
+
+	// Number of rows for window w
+	static int positions(int w)
+	{
+		return (256 + w - 1) / w;
+	}
+
+	// Bytes of a table file with window w
+	static size_t size(int w)
+	{
+		return sizeof(Header) + (size_t)positions(w) * (1 << (w-1)) * 8 * sizeof(uint64_t);
+	}
+
+	// Whether entry idx of row pos is (2*idx+1) * pow2 * G, pow2 = 2^(w*pos)
+	bool isMultiple(int pos, int idx, const typename C::Scalar &pow2) const
+	{
+		Point<C> e = lookupVar(pos, idx);
+		Point<C> q = toAffine<C>(scalarMulVar<C>(pow2 * (2*idx + 1), generator<C>()));
+		return e.x == q.x && e.y == q.y;
+	}
+
+	// Check every entry, done once when the table is written: all lie on
+	// the curve, and the first and last entry of every row are compared
+	// with a multiplication that does not use the table
+	bool verifyAll() const
+	{
+		typename C::Scalar pow2 = 1;
+		for (int i=0; i<positions(w); i++)
+		{
+			for (int j=0; j<entries; j++)
+				if (!onCurve<C>(lookupVar(i, j)))
+					return false;
+			if (!isMultiple(i, 0, pow2) || !isMultiple(i, entries - 1, pow2))
+				return false;
+			for (int k=0; k<w; k++)
+				pow2 = pow2 + pow2;
+		}
+		return true;
+	}
+
+	// Quick check on every load: the first entry is the generator, which
+	// also rejects a file of another byte order, and SAMPLES entries from
+	// the first to the last lie on the curve
+	bool verifySamples() const
+	{
+		Point<C> g = lookupVar(0, 0);
+		if (g.x != C::Gx || g.y != C::Gy)
+			return false;
+		size_t total = (size_t)positions(w) * entries;
+		for (int k=1; k<SAMPLES; k++)
+		{
+			size_t e = (total - 1) * k / (SAMPLES - 1);
+			if (!onCurve<C>(lookupVar(e / entries, e % entries)))
+				return false;
+		}
+		return true;
+	}
+
+	// Map the file and check it, NULL if it is absent or not valid
+	// Only the header and a few entries are checked (see verifySamples),
+	// the whole table was checked when it was written
+	static const GenTableMap *load(const string &file)
+	{
+		int fd = open(file.c_str(), O_RDONLY);
+		if (fd < 0)
+			return NULL;
+		struct stat st;
+		void *p = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header))
+			p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			return NULL;
+
+		const Header *h = (const Header *)p;
+		GenTableMap *map = NULL;
+		if (memcmp(h->magic, MAGIC, 8) == 0 && strncmp(h->curve, C::NAME, sizeof(h->curve)) == 0 &&
+			h->window >= 2 && h->window <= 16 && (int)h->positions == positions(h->window) &&
+			(size_t)st.st_size == size(h->window))
+		{
+			map = new GenTableMap(h);
+			if (!map->verifySamples())
+			{
+				delete map;
+				map = NULL;
+			}
+		}
+		if (map == NULL)
+			munmap(p, st.st_size);
+		return map;
+	}
+
+public:
+	// File name of the table of curve C
+	static string fileName()
+	{
+		return string(C::NAME) + ".gentable";
+	}
+
+	// Table of the working directory, NULL if there is none
+	// The file is mapped once and stays mapped until the process ends
+	static const GenTableMap *get()
+	{
+		static const GenTableMap *map = load(fileName());
+		return map;
+	}
+
+	// Bits per digit
+	int window() const
+	{
+		return w;
+	}
+
+	// Entry idx of row pos, every entry of the row is read and masked
+	Point<C> lookup(int pos, int idx) const
+	{
+		const uint64_t *row = data + (size_t)pos * entries * 8;
+		uint64_t d[8];
+		for (int k=0; k<8; k++)
+			d[k] = row[k];
+		for (int j=1; j<entries; j++)
+		{
+			uint64_t mask = -(uint64_t)(j == idx);
+			const uint64_t *e = row + 8*j;
+			for (int k=0; k<8; k++)
+				d[k] ^= mask & (d[k] ^ e[k]);
+		}
+		return fromWords(d);
+	}
+
+	// Entry idx of row pos in variable time, only for public values
+	Point<C> lookupVar(int pos, int idx) const
+	{
+		return fromWords(data + ((size_t)pos * entries + idx) * 8);
+	}
+
+	// Write the table with window w (2 to 16) to file, return false on failure
+	// The whole table is built in memory and checked (see verifyAll) before
+	// it is written to a temporary file and renamed, so processes mapping
+	// an older table are not disturbed
+	static bool write(const string &file, int w)
+	{
+		if (w < 2 || w > 16)
+			return false;
+
+		// Header and rows in one buffer, each row made affine with one inversion
+		vector<uint64_t> buf(size(w) / sizeof(uint64_t));
+		Header *h = (Header *)buf.data();
+		memcpy(h->magic, MAGIC, 8);
+		strncpy(h->curve, C::NAME, sizeof(h->curve) - 1);
+		h->window = w;
+		h->positions = positions(w);
+		GenTableMap table(h);
+		int entries = table.entries;
+		vector<Jacobian<C>> jac(entries);
+		vector<Point<C>> aff(entries);
+		Jacobian<C> base = toJacobian<C>(generator<C>());
+		for (int i=0; i<positions(w); i++)
+		{
+			Jacobian<C> twice = dbl<C>(base);
+			jac[0] = base;
+			for (int j=1; j<entries; j++)
+				jac[j] = add<C>(jac[j-1], twice);
+			toAffineAll<C>(aff.data(), jac.data(), entries);
+			uint64_t *row = (uint64_t *)table.data + (size_t)i * entries * 8;
+			for (int j=0; j<entries; j++)
+			{
+				getWords(row + 8*j, aff[j].x);
+				getWords(row + 8*j + 4, aff[j].y);
+			}
+			for (int k=0; k<w; k++)
+				base = dbl<C>(base);
+		}
+		if (!table.verifyAll())
+			return false;
+
+		string tmp = file + ".tmp";
+		FILE *f = fopen(tmp.c_str(), "wb");
+		if (f == NULL)
+			return false;
+		bool ok = fwrite(buf.data(), sizeof(uint64_t), buf.size(), f) == buf.size();
+		ok = (fclose(f) == 0) && ok;
+		if (ok)
+			ok = rename(tmp.c_str(), file.c_str()) == 0;
+		if (!ok)
+			remove(tmp.c_str());
+		return ok;
+	}
+};
+#endif
@@ -0,0 +1,28 @@
+#ifndef GUARD_HEX
+#define GUARD_HEX
+
+// Table driven conversion of bytes to lower case hex, without allocation
+#include <stdint.h>
+#include <stddef.h>
+
+// Write the 2*len hex digits of b to out, followed by a terminating zero
+inline void hexEncode(char *out, const uint8_t *b, size_t len)
+{
+	// Both digits of every byte value
+	static const char digits[513] =
+		"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+		"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+		"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+		"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+		"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+		"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+		"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+		"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+	for (size_t i=0; i<len; i++)
+	{
+		out[2*i] = digits[2*b[i]];
+		out[2*i+1] = digits[2*b[i]+1];
+	}
+	out[2*len] = 0;
+}
+#endif
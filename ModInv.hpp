@@ -0,0 +1,396 @@
+#ifndef GUARD_MODINV
+#define GUARD_MODINV
+
+// Modular inversion by the safegcd algorithm of Bernstein and Yang
+// See: https://gcd.cr.yp.to/safegcd-20190413.pdf
+// Numbers are handled in five signed 62 bit limbs. Each round performs
+// 59 (or 62) division steps on the lowest limbs only and applies the
+// resulting 2x2 transition matrix to the full numbers.
+//
+// inv()       always does 590 steps and never branches on the value, for secrets
+// invVar()    stops as soon as g is zero, for public values
+// jacobiVar() runs the same steps on f and g only, tracking the Jacobi symbol
+#include <stdint.h>
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
+
+class ModInv
+{
+public:
+	// Number as sum of v[i]*2^(62*i), limbs may be negative
+	struct Signed62
+	{
+		int64_t v[5];
+	};
+
+	// Modulus and its inverse mod 2^62
+	struct Info
+	{
+		Signed62 modulus;
+		uint64_t modulusInv62;
+	};
+
+private:
+	static const uint64_t M62 = UINT64_MAX >> 2;
+
+	// Transition matrix of a batch of division steps, scaled by 2^62
+	struct Trans
+	{
+		int64_t u, v, q, r;
+	};
+
+	// 59 branch free division steps, zeta = -(delta+1/2)
+	static int64_t divsteps59(int64_t zeta, uint64_t f0, uint64_t g0, Trans &t)
+	{
+		// Start with identity * 2^3, so 59 steps give a scale of 2^62
+		uint64_t u = 8, v = 0, q = 0, r = 8;
+		volatile uint64_t c1, c2;
+		uint64_t mask1, mask2, f = f0, g = g0, x, y, z;
+		for (int i=3; i<62; i++)
+		{
+			// If zeta < 0 and g is odd, swap (f,u,v) with (g,q,r) and negate
+			c1 = zeta >> 63;
+			mask1 = c1;
+			c2 = g & 1;
+			mask2 = -c2;
+			x = (f ^ mask1) - mask1;
+			y = (u ^ mask1) - mask1;
+			z = (v ^ mask1) - mask1;
+			g += x & mask2;
+			q += y & mask2;
+			r += z & mask2;
+			mask1 &= mask2;
+			zeta = (zeta ^ mask1) - 1;
+			f += g & mask1;
+			u += q & mask1;
+			v += r & mask1;
+			g >>= 1;
+			u <<= 1;
+			v <<= 1;
+		}
+		t.u = u; t.v = v; t.q = q; t.r = r;
+		return zeta;
+	}
+
+	// Up to 62 division steps, skipping runs of zeros, eta = -delta
+	static int64_t divsteps62Var(int64_t eta, uint64_t f0, uint64_t g0, Trans &t)
+	{
+		uint64_t u = 1, v = 0, q = 0, r = 1;
+		uint64_t f = f0, g = g0, m, w;
+		int i = 62, limit, zeros;
+		for (;;)
+		{
+			// Remove all trailing zeros of g at once (at most i of them)
+			zeros = __builtin_ctzll(g | (UINT64_MAX << i));
+			g >>= zeros;
+			u <<= zeros;
+			v <<= zeros;
+			eta -= zeros;
+			i -= zeros;
+			if (i == 0)
+				break;
+
+			// f and g are odd now
+			if (eta < 0)
+			{
+				uint64_t tmp;
+				eta = -eta;
+				tmp = f; f = g; g = -tmp;
+				tmp = u; u = q; q = -tmp;
+				tmp = v; v = r; r = -tmp;
+
+				// Cancel up to 6 bits of g with a multiple of f
+				limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+				m = (UINT64_MAX >> (64 - limit)) & 63U;
+				w = (f * g * (f * f - 2)) & m;
+			}
+			else
+			{
+				// Cancel up to 4 bits of g with a multiple of f
+				limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+				m = (UINT64_MAX >> (64 - limit)) & 15U;
+				w = f + (((f + 1) & 4) << 1);
+				w = (-w * g) & m;
+			}
+			g += f * w;
+			q += u * w;
+			r += v * w;
+		}
+		t.u = u; t.v = v; t.q = q; t.r = r;
+		return eta;
+	}
+
+	// Up to 62 division steps that keep f and g positive, eta = -delta
+	// The lowest bit of jac flips with every sign change of the Jacobi symbol
+	static int64_t posDivsteps62Var(int64_t eta, uint64_t f0, uint64_t g0, Trans &t, int &jac)
+	{
+		uint64_t u = 1, v = 0, q = 0, r = 1;
+		uint64_t f = f0, g = g0, m, w;
+		int i = 62, limit, zeros;
+		for (;;)
+		{
+			// Remove trailing zeros of g, (2/f) = -1 for f = 3 or 5 (mod 8)
+			zeros = __builtin_ctzll(g | (UINT64_MAX << i));
+			g >>= zeros;
+			u <<= zeros;
+			v <<= zeros;
+			eta -= zeros;
+			i -= zeros;
+			jac ^= (zeros & ((f >> 1) ^ (f >> 2)));
+			if (i == 0)
+				break;
+
+			// Swap without negation, by reciprocity the symbol changes
+			// sign when both are 3 (mod 4)
+			if (eta < 0)
+			{
+				uint64_t tmp;
+				eta = -eta;
+				tmp = f; f = g; g = tmp;
+				tmp = u; u = q; q = tmp;
+				tmp = v; v = r; r = tmp;
+				jac ^= ((f & g) >> 1);
+			}
+
+			// Cancel up to 6 bits of g with a multiple of f
+			limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+			m = (UINT64_MAX >> (64 - limit)) & 63U;
+			w = (f * g * (f * f - 2)) & m;
+			g += f * w;
+			q += u * w;
+			r += v * w;
+		}
+		t.u = u; t.v = v; t.q = q; t.r = r;
+		return eta;
+	}
+
+	// [d,e] = t * [d,e] / 2^62 (mod modulus), keeping both in (-2*modulus,modulus)
+	static void updateDE(Signed62 &d, Signed62 &e, const Trans &t, const Info &info)
+	{
+		const int64_t u = t.u, v = t.v, q = t.q, r = t.r;
+		const Signed62 &mod = info.modulus;
+
+		// Add modulus multiples md, me to make the result divisible by 2^62,
+		// plus a correction if d or e are negative
+		int64_t sd = d.v[4] >> 63;
+		int64_t se = e.v[4] >> 63;
+		int64_t md = (u & sd) + (v & se);
+		int64_t me = (q & sd) + (r & se);
+		int128_t cd = (int128_t)u * d.v[0] + (int128_t)v * e.v[0];
+		int128_t ce = (int128_t)q * d.v[0] + (int128_t)r * e.v[0];
+		md -= (info.modulusInv62 * (uint64_t)cd + md) & M62;
+		me -= (info.modulusInv62 * (uint64_t)ce + me) & M62;
+		cd += (int128_t)mod.v[0] * md;
+		ce += (int128_t)mod.v[0] * me;
+		cd >>= 62;
+		ce >>= 62;
+
+		for (int i=1; i<5; i++)
+		{
+			cd += (int128_t)u * d.v[i] + (int128_t)v * e.v[i] + (int128_t)mod.v[i] * md;
+			ce += (int128_t)q * d.v[i] + (int128_t)r * e.v[i] + (int128_t)mod.v[i] * me;
+			d.v[i-1] = (int64_t)cd & M62;
+			e.v[i-1] = (int64_t)ce & M62;
+			cd >>= 62;
+			ce >>= 62;
+		}
+		d.v[4] = (int64_t)cd;
+		e.v[4] = (int64_t)ce;
+	}
+
+	// [f,g] = t * [f,g] / 2^62, only the lowest len limbs are in use
+	static void updateFG(int len, Signed62 &f, Signed62 &g, const Trans &t)
+	{
+		const int64_t u = t.u, v = t.v, q = t.q, r = t.r;
+		int128_t cf = (int128_t)u * f.v[0] + (int128_t)v * g.v[0];
+		int128_t cg = (int128_t)q * f.v[0] + (int128_t)r * g.v[0];
+		cf >>= 62;
+		cg >>= 62;
+		for (int i=1; i<len; i++)
+		{
+			cf += (int128_t)u * f.v[i] + (int128_t)v * g.v[i];
+			cg += (int128_t)q * f.v[i] + (int128_t)r * g.v[i];
+			f.v[i-1] = (int64_t)cf & M62;
+			g.v[i-1] = (int64_t)cg & M62;
+			cf >>= 62;
+			cg >>= 62;
+		}
+		f.v[len-1] = (int64_t)cf;
+		g.v[len-1] = (int64_t)cg;
+	}
+
+	// Bring r from (-2*modulus,modulus) to [0,modulus), negating it if sign < 0
+	static void normalize(Signed62 &r, int64_t sign, const Info &info)
+	{
+		const Signed62 &mod = info.modulus;
+		volatile int64_t condAdd, condNegate;
+
+		// Add the modulus if negative, then negate if requested
+		condAdd = r.v[4] >> 63;
+		for (int i=0; i<5; i++)
+			r.v[i] += mod.v[i] & condAdd;
+		condNegate = sign >> 63;
+		for (int i=0; i<5; i++)
+			r.v[i] = (r.v[i] ^ condNegate) - condNegate;
+		for (int i=0; i<4; i++)
+		{
+			r.v[i+1] += r.v[i] >> 62;
+			r.v[i] &= M62;
+		}
+
+		// Add the modulus again if still negative
+		condAdd = r.v[4] >> 63;
+		for (int i=0; i<5; i++)
+			r.v[i] += mod.v[i] & condAdd;
+		for (int i=0; i<4; i++)
+		{
+			r.v[i+1] += r.v[i] >> 62;
+			r.v[i] &= M62;
+		}
+	}
+
+public:
+	// Convert from four 64 bit words (least significant first)
+	static Signed62 fromWords(const uint64_t *a)
+	{
+		Signed62 r;
+		r.v[0] = a[0] & M62;
+		r.v[1] = (a[0] >> 62 | a[1] << 2) & M62;
+		r.v[2] = (a[1] >> 60 | a[2] << 4) & M62;
+		r.v[3] = (a[2] >> 58 | a[3] << 6) & M62;
+		r.v[4] = a[3] >> 56;
+		return r;
+	}
+
+	// Modulus information for an odd modulus given as four 64 bit words,
+	// for constants computed by the compiler
+	static constexpr Info makeInfo(const uint64_t *p)
+	{
+		// p^-1 mod 2^64 by Newton iteration, each step doubles the correct bits
+		uint64_t x = p[0];
+		for (int i=0; i<5; i++)
+			x *= 2 - p[0] * x;
+		Info r = {{{(int64_t)(p[0] & M62),
+		            (int64_t)((p[0] >> 62 | p[1] << 2) & M62),
+		            (int64_t)((p[1] >> 60 | p[2] << 4) & M62),
+		            (int64_t)((p[2] >> 58 | p[3] << 6) & M62),
+		            (int64_t)(p[3] >> 56)}}, x & M62};
+		return r;
+	}
+
+	// Convert to four 64 bit words, input must be in [0,2^256)
+	static void toWords(uint64_t *a, const Signed62 &r)
+	{
+		a[0] = (uint64_t)r.v[0]      | (uint64_t)r.v[1] << 62;
+		a[1] = (uint64_t)r.v[1] >> 2 | (uint64_t)r.v[2] << 60;
+		a[2] = (uint64_t)r.v[2] >> 4 | (uint64_t)r.v[3] << 58;
+		a[3] = (uint64_t)r.v[3] >> 6 | (uint64_t)r.v[4] << 56;
+	}
+
+	// x = x^-1 (mod modulus) in constant time, the inverse of zero is zero
+	static void inv(Signed62 &x, const Info &info)
+	{
+		Signed62 d = {{0, 0, 0, 0, 0}};
+		Signed62 e = {{1, 0, 0, 0, 0}};
+		Signed62 f = info.modulus;
+		Signed62 g = x;
+		int64_t zeta = -1;
+		for (int i=0; i<10; i++)
+		{
+			Trans t;
+			zeta = divsteps59(zeta, f.v[0], g.v[0], t);
+			updateDE(d, e, t, info);
+			updateFG(5, f, g, t);
+		}
+
+		// Now g is zero and f is +1 or -1
+		normalize(d, f.v[4], info);
+		x = d;
+	}
+
+	// x = x^-1 (mod modulus) in variable time, the inverse of zero is zero
+	static void invVar(Signed62 &x, const Info &info)
+	{
+		Signed62 d = {{0, 0, 0, 0, 0}};
+		Signed62 e = {{1, 0, 0, 0, 0}};
+		Signed62 f = info.modulus;
+		Signed62 g = x;
+		int len = 5;
+		int64_t eta = -1;
+		int64_t cond, fn, gn;
+		for (;;)
+		{
+			Trans t;
+			eta = divsteps62Var(eta, f.v[0], g.v[0], t);
+			updateDE(d, e, t, info);
+			updateFG(len, f, g, t);
+
+			// Stop when g is zero
+			if (g.v[0] == 0)
+			{
+				cond = 0;
+				for (int j=1; j<len; j++)
+					cond |= g.v[j];
+				if (cond == 0)
+					break;
+			}
+
+			// Drop the top limb of f and g when both are just sign extension
+			fn = f.v[len-1];
+			gn = g.v[len-1];
+			cond = ((int64_t)len - 2) >> 63;
+			cond |= fn ^ (fn >> 63);
+			cond |= gn ^ (gn >> 63);
+			if (cond == 0)
+			{
+				f.v[len-2] |= (uint64_t)fn << 62;
+				g.v[len-2] |= (uint64_t)gn << 62;
+				len--;
+			}
+		}
+		normalize(d, f.v[len-1], info);
+		x = d;
+	}
+
+	// Jacobi symbol (x/modulus) in variable time, x must be in (0,modulus)
+	// Return 0 if the result was not found within the step limit
+	static int jacobiVar(const Signed62 &x, const Info &info)
+	{
+		Signed62 f = info.modulus;
+		Signed62 g = x;
+		int len = 5;
+		int64_t eta = -1;
+		int64_t cond;
+		int jac = 0;
+
+		// Positive steps converge to f = gcd(x,modulus) = 1, but need more
+		// rounds than the inversion, 25 rounds (1550 steps) are plenty
+		for (int count=0; count<25; count++)
+		{
+			Trans t;
+			eta = posDivsteps62Var(eta, f.v[0] | (uint64_t)f.v[1] << 62,
+			                       g.v[0] | (uint64_t)g.v[1] << 62, t, jac);
+			updateFG(len, f, g, t);
+
+			// Done when f is 1, (g/1) = 1 so the tracked sign is the result
+			if (f.v[0] == 1)
+			{
+				cond = 0;
+				for (int j=1; j<len; j++)
+					cond |= f.v[j];
+				if (cond == 0)
+					return 1 - 2*(jac & 1);
+			}
+
+			// Drop the top limb of f and g when both are zero
+			cond = ((int64_t)len - 2) >> 63;
+			cond |= f.v[len-1];
+			cond |= g.v[len-1];
+			if (cond == 0)
+				len--;
+		}
+		return 0;
+	}
+};
+#endif
@@ -0,0 +1,431 @@
+#ifndef GUARD_MONTGOMERY
+#define GUARD_MONTGOMERY
+
+// Galois Field with a modulus fixed at compile time
+// Values are kept in Montgomery form, num * 2^256 (mod p), in four 64 bit
+// limbs. The modulus is given by a type with a member
+//     static constexpr uint64_t p[4];  // odd prime < 2^256, least significant first
+// and every constant derived from it is computed by the compiler.
+#include <gmpxx.h>  // mpz_class (bignum)
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "ModInv.hpp"
+#include "Hex.hpp"
+using namespace std;
+
+// 256 bit number as four 64 bit limbs, usable in constant expressions
+struct Limbs4
+{
+	uint64_t v[4];
+};
+
+// -p^-1 mod 2^64 by Newton iteration, each step doubles the correct bits
+template <class Modulus>
+constexpr uint64_t montNegInv()
+{
+	uint64_t x = Modulus::p[0];
+	for (int i=0; i<5; i++)
+		x *= 2 - Modulus::p[0] * x;
+	return -x;
+}
+
+// 2^k mod p by repeated doubling
+template <class Modulus>
+constexpr Limbs4 montPow2(int k)
+{
+	Limbs4 r = {{1, 0, 0, 0}};
+	for (int i=0; i<k; i++)
+	{
+		uint64_t top = r.v[3] >> 63;
+		r.v[3] = r.v[3] << 1 | r.v[2] >> 63;
+		r.v[2] = r.v[2] << 1 | r.v[1] >> 63;
+		r.v[1] = r.v[1] << 1 | r.v[0] >> 63;
+		r.v[0] = r.v[0] << 1;
+
+		// Compare with p starting from the most significant limb
+		bool ge = top;
+		if (!top)
+		{
+			ge = true;
+			for (int j=3; j>=0; j--)
+			{
+				if (r.v[j] != Modulus::p[j])
+				{
+					ge = r.v[j] > Modulus::p[j];
+					break;
+				}
+			}
+		}
+		if (ge)
+		{
+			uint64_t borrow = 0;
+			for (int j=0; j<4; j++)
+			{
+				uint64_t d = r.v[j] - Modulus::p[j] - borrow;
+				borrow = (r.v[j] < Modulus::p[j]) | ((r.v[j] == Modulus::p[j]) & borrow);
+				r.v[j] = d;
+			}
+		}
+	}
+	return r;
+}
+
+template <class Modulus>
+class MontGF
+{
+private:
+	uint64_t n[4];
+
+	static constexpr uint64_t PINV = montNegInv<Modulus>();
+	static constexpr Limbs4 R2 = montPow2<Modulus>(512);   // R^2 mod p
+	static constexpr ModInv::Info INV_INFO = ModInv::makeInfo(Modulus::p);
+
+	// Subtract p if t (with carry bit above it) is not below p
+	static void reduceOnce(uint64_t *r, const uint64_t *t, uint64_t carry)
+	{
+		uint64_t s[4];
+		uint64_t borrow = 0;
+		for (int j=0; j<4; j++)
+		{
+			uint128_t d = (uint128_t)t[j] - Modulus::p[j] - borrow;
+			s[j] = (uint64_t)d;
+			borrow = (uint64_t)(d >> 64) & 1;
+		}
+
+		// Keep t only when there was no carry and the subtraction borrowed
+		uint64_t keep = -(uint64_t)((carry == 0) & (borrow == 1));
+		for (int j=0; j<4; j++)
+			r[j] = (t[j] & keep) | (s[j] & ~keep);
+	}
+
+	// r = a * b / R (mod p), coarsely integrated operand scanning
+	static void mul(uint64_t *r, const uint64_t *a, const uint64_t *b)
+	{
+		uint64_t t[6] = {0, 0, 0, 0, 0, 0};
+		for (int i=0; i<4; i++)
+		{
+			// t += a * b[i]
+			uint128_t c = 0;
+			for (int j=0; j<4; j++)
+			{
+				c += (uint128_t)a[j] * b[i] + t[j];
+				t[j] = (uint64_t)c;
+				c >>= 64;
+			}
+			c += t[4];
+			t[4] = (uint64_t)c;
+			t[5] = (uint64_t)(c >> 64);
+
+			// t = (t + m*p) / 2^64, with m chosen to clear the low limb
+			uint64_t m = t[0] * PINV;
+			c = (uint128_t)m * Modulus::p[0] + t[0];
+			c >>= 64;
+			for (int j=1; j<4; j++)
+			{
+				c += (uint128_t)m * Modulus::p[j] + t[j];
+				t[j-1] = (uint64_t)c;
+				c >>= 64;
+			}
+			c += t[4];
+			t[3] = (uint64_t)c;
+			t[4] = t[5] + (uint64_t)(c >> 64);
+		}
+		reduceOnce(r, t, t[4]);
+	}
+
+	// Modulus as bignum, only needed to convert from arbitrary values
+	static const mpz_class &prime()
+	{
+		static const mpz_class p = [] {
+			mpz_class r;
+			mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, Modulus::p);
+			return r;
+		}();
+		return p;
+	}
+
+public:
+	// Empty constructor
+	MontGF ()
+	{
+		n[0] = n[1] = n[2] = n[3] = 0;
+	}
+
+	// Constructor from small integer
+	MontGF (int v)
+	{
+		uint64_t d[4] = {0, 0, 0, 0};
+		d[0] = v < 0 ? -(uint64_t)v : (uint64_t)v;
+		reduceOnce(d, d, 0);
+		mul(n, d, R2.v);
+		if (v < 0)
+			*this = -*this;
+	}
+
+	// Constructor from bignum
+	MontGF (const mpz_class &v)
+	{
+		mpz_class r;
+		mpz_mod(r.get_mpz_t(), v.get_mpz_t(), prime().get_mpz_t());
+		uint64_t d[4] = {0, 0, 0, 0};
+		mpz_export(d, NULL, -1, sizeof(uint64_t), 0, 0, r.get_mpz_t());
+		mul(n, d, R2.v);
+	}
+
+	// Load a 32 byte big endian number, reduced mod p
+	// Optionally report whether the number was >= p
+	static MontGF fromBytes32(const uint8_t *b, bool *overflowed=NULL)
+	{
+		static_assert(Modulus::p[3] >> 63, "one subtraction only reduces below 2^256 for p > 2^255");
+		uint64_t d[4];
+		for (int j=0; j<4; j++)
+		{
+			const uint8_t *w = b + 24 - 8*j;
+			d[j] = (uint64_t)w[0] << 56 | (uint64_t)w[1] << 48 | (uint64_t)w[2] << 40 |
+			       (uint64_t)w[3] << 32 | (uint64_t)w[4] << 24 | (uint64_t)w[5] << 16 |
+			       (uint64_t)w[6] << 8  | (uint64_t)w[7];
+		}
+		uint64_t r[4];
+		reduceOnce(r, d, 0);
+		if (overflowed)
+			*overflowed = (r[0] ^ d[0]) | (r[1] ^ d[1]) | (r[2] ^ d[2]) | (r[3] ^ d[3]);
+		MontGF m;
+		mul(m.n, r, R2.v);
+		return m;
+	}
+
+	// Store as 32 byte big endian number
+	void toBytes32(uint8_t *b) const
+	{
+		static const uint64_t one[4] = {1, 0, 0, 0};
+		uint64_t d[4];
+		mul(d, n, one);
+		for (int j=0; j<4; j++)
+			for (int k=0; k<8; k++)
+				b[31 - 8*j - k] = d[j] >> (8*k);
+	}
+
+	// Write 64 hex digits and a terminating zero to out
+	void toHex(char *out) const
+	{
+		uint8_t b[32];
+		toBytes32(b);
+		hexEncode(out, b, 32);
+	}
+
+	// Return num
+	mpz_class getNum() const
+	{
+		static const uint64_t one[4] = {1, 0, 0, 0};
+		uint64_t d[4];
+		mul(d, n, one);
+		mpz_class r;
+		mpz_import(r.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, d);
+		return r;
+	}
+
+	// Return string
+	string toStr(int base=16) const
+	{
+		return getNum().get_str(base) + " (mod " + prime().get_str(base) + ")";
+	}
+
+	// Check if zero
+	bool isZero() const
+	{
+		return (n[0] | n[1] | n[2] | n[3]) == 0;
+	}
+
+	// Check if equal
+	bool operator==(const MontGF &other) const
+	{
+		return ((n[0] ^ other.n[0]) | (n[1] ^ other.n[1]) |
+				(n[2] ^ other.n[2]) | (n[3] ^ other.n[3])) == 0;
+	}
+
+	// Check if equal with int
+	bool operator==(int v) const
+	{
+		return *this == MontGF(v);
+	}
+
+	// Check if not equal
+	bool operator!=(const MontGF &other) const
+	{
+		return !(*this == other);
+	}
+
+	// Check if not equal with int
+	bool operator!=(int v) const
+	{
+		return !(*this == MontGF(v));
+	}
+
+	// Constant time conditional move: num = a if flag is 1, unchanged if 0
+	void cmov(const MontGF &a, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+			n[j] ^= mask & (n[j] ^ a.n[j]);
+	}
+
+	// Constant time select: a if flag is 0, b if flag is 1
+	static MontGF select(const MontGF &a, const MontGF &b, int flag)
+	{
+		MontGF r = a;
+		r.cmov(b, flag);
+		return r;
+	}
+
+	// Constant time conditional swap of a and b if flag is 1
+	static void cswap(MontGF &a, MontGF &b, int flag)
+	{
+		uint64_t mask = -(uint64_t)flag;
+		for (int j=0; j<4; j++)
+		{
+			uint64_t t = mask & (a.n[j] ^ b.n[j]);
+			a.n[j] ^= t;
+			b.n[j] ^= t;
+		}
+	}
+
+	// Constant time conditional negation if flag is 1
+	void cneg(int flag)
+	{
+		cmov(-*this, flag);
+	}
+
+	// Define addition
+	MontGF operator+(const MontGF &other) const
+	{
+		uint64_t t[4];
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)n[j] + other.n[j];
+			t[j] = (uint64_t)c;
+			c >>= 64;
+		}
+		MontGF r;
+		reduceOnce(r.n, t, (uint64_t)c);
+		return r;
+	}
+
+	// Define negative number
+	MontGF operator-() const
+	{
+		return MontGF() - *this;
+	}
+
+	// Define subtraction
+	MontGF operator-(const MontGF &other) const
+	{
+		// Subtract and add p back if it borrowed
+		MontGF r;
+		uint64_t borrow = 0;
+		for (int j=0; j<4; j++)
+		{
+			uint128_t d = (uint128_t)n[j] - other.n[j] - borrow;
+			r.n[j] = (uint64_t)d;
+			borrow = (uint64_t)(d >> 64) & 1;
+		}
+		uint64_t mask = -borrow;
+		uint128_t c = 0;
+		for (int j=0; j<4; j++)
+		{
+			c += (uint128_t)r.n[j] + (Modulus::p[j] & mask);
+			r.n[j] = (uint64_t)c;
+			c >>= 64;
+		}
+		return r;
+	}
+
+	// Define multiplication
+	MontGF operator*(const MontGF &other) const
+	{
+		MontGF r;
+		mul(r.n, n, other.n);
+		return r;
+	}
+
+	// a * b + c
+	static MontGF mulAdd(const MontGF &a, const MontGF &b, const MontGF &c)
+	{
+		return a * b + c;
+	}
+
+	// a * b - c
+	static MontGF mulSub(const MontGF &a, const MontGF &b, const MontGF &c)
+	{
+		return a * b - c;
+	}
+
+	// Define inverse in constant time (inverse of zero is zero)
+	// The value leaves Montgomery form for the safegcd inversion
+	MontGF inv() const
+	{
+		static const uint64_t one[4] = {1, 0, 0, 0};
+		uint64_t d[4];
+		mul(d, n, one);
+		ModInv::Signed62 x = ModInv::fromWords(d);
+		ModInv::inv(x, INV_INFO);
+		ModInv::toWords(d, x);
+		MontGF r;
+		mul(r.n, d, R2.v);
+		return r;
+	}
+
+	// Define inverse in variable time, only for public values
+	MontGF invVar() const
+	{
+		static const uint64_t one[4] = {1, 0, 0, 0};
+		uint64_t d[4];
+		mul(d, n, one);
+		ModInv::Signed62 x = ModInv::fromWords(d);
+		ModInv::invVar(x, INV_INFO);
+		ModInv::toWords(d, x);
+		MontGF r;
+		mul(r.n, d, R2.v);
+		return r;
+	}
+
+	// Define division
+	MontGF operator/(const MontGF &other) const
+	{
+		return *this * other.inv();
+	}
+
+	// Invert len elements at once with Montgomery's trick: one inversion
+	// plus 3*(len-1) multiplications. Zeros are inverted to zero.
+	// r and a must not overlap.
+	static void invAll(MontGF *r, const MontGF *a, size_t len)
+	{
+		if (len == 0)
+			return;
+
+		// r[i] = product of all nonzero a[0..i]
+		MontGF acc(1);
+		for (size_t i=0; i<len; i++)
+		{
+			if (!a[i].isZero())
+				acc = acc * a[i];
+			r[i] = acc;
+		}
+
+		// Walk back, peeling one factor off the inverse at a time
+		MontGF inv = acc.inv();
+		for (size_t i=len-1; i>0; i--)
+		{
+			if (a[i].isZero())
+			{
+				r[i] = 0;
+				continue;
+			}
+			r[i] = r[i-1] * inv;
+			inv = inv * a[i];
+		}
+		r[0] = a[0].isZero() ? MontGF() : inv;
+	}
+};
+#endif
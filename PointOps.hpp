@@ -0,0 +1,419 @@
+#ifndef GUARD_POINTOPS
+#define GUARD_POINTOPS
+
+// Point arithmetic for any curve of Curve.hpp
+// Points are accumulated in Jacobian coordinates and made affine once at
+// the end. Scalar multiplication comes in three flavours:
+//     scalarMulVar     width W NAF in variable time, for public values
+//     scalarMulGen     the generator from a precomputed comb table, no doublings
+//     scalarMulGenVar  the same with direct table access, for public values
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include "Curve.hpp"
+using namespace std;
+
+// Generator of the curve
+template <class C>
+Point<C> generator()
+{
+	return Point<C>{C::Gx, C::Gy};
+}
+
+// Point at infinity in Jacobian coordinates
+template <class C>
+Jacobian<C> infinity()
+{
+	return Jacobian<C>{1, 1, 0};
+}
+
+// Affine to Jacobian, (0,0) stands for the point at infinity
+template <class C>
+Jacobian<C> toJacobian(const Point<C> &p)
+{
+	if (p.x == 0 && p.y == 0)
+		return infinity<C>();
+	return Jacobian<C>{p.x, p.y, 1};
+}
+
+// Jacobian to affine with one inversion, infinity becomes (0,0)
+template <class C>
+Point<C> toAffine(const Jacobian<C> &p)
+{
+	typename C::Field zi = p.z.inv();
+	typename C::Field zi2 = zi.sqr();
+	return Point<C>{p.x * zi2, p.y * zi2 * zi};
+}
+
+// Whether the affine point p satisfies y^2 = x^3 + a*x + b
+template <class C>
+bool onCurve(const Point<C> &p)
+{
+	return p.y.sqr() == (p.x.sqr() + C::A) * p.x + C::B;
+}
+
+// Doubling operation on the elliptic curve, in Jacobian coordinates
+// It never compares coordinates; the doubling of infinity (Z = 0) stays
+// at infinity. Each curve gets the formula for its a coefficient.
+// See: https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html
+template <class C>
+Jacobian<C> dbl(const Jacobian<C> &p)
+{
+	typedef typename C::Field Field;
+	Jacobian<C> r;
+	if constexpr (C::A == 0)
+	{
+		// dbl-2009-l, 2M + 5S
+		// A = X^2, B = Y^2, C = B^2, D = 2*((X+B)^2 - A - C), E = 3*A
+		// X3 = E^2 - 2*D, Y3 = E*(D - X3) - 8*C, Z3 = 2*Y*Z
+		Field a = p.x.sqr();
+		Field b = p.y.sqr();
+		Field c = b.sqr();
+		Field d = ((p.x + b).sqr() - a - c) * 2;
+		Field e = a * 3;
+		r.x = e.sqr() - d * 2;
+		r.y = Field::mulSub(e, d - r.x, c * 8);
+		r.z = p.y * p.z * 2;
+	}
+	else if constexpr (C::A == -3)
+	{
+		// dbl-2001-b, 3M + 5S
+		// delta = Z^2, gamma = Y^2, beta = X*gamma, alpha = 3*(X - delta)*(X + delta)
+		// X3 = alpha^2 - 8*beta, Y3 = alpha*(4*beta - X3) - 8*gamma^2
+		// Z3 = (Y + Z)^2 - gamma - delta
+		Field delta = p.z.sqr();
+		Field gamma = p.y.sqr();
+		Field beta = p.x * gamma;
+		Field alpha = (p.x - delta) * (p.x + delta) * 3;
+		r.x = alpha.sqr() - beta * 8;
+		r.y = Field::mulSub(alpha, beta * 4 - r.x, gamma.sqr() * 8);
+		r.z = (p.y + p.z).sqr() - gamma - delta;
+	}
+	else
+	{
+		// Any a: M = 3*X^2 + a*Z^4, S = 4*X*Y^2
+		// X3 = M^2 - 2*S, Y3 = M*(S - X3) - 8*Y^4, Z3 = 2*Y*Z
+		Field yy = p.y.sqr();
+		Field m = p.x.sqr() * 3 + p.z.sqr().sqr() * C::A;
+		Field s = p.x * yy * 4;
+		r.x = m.sqr() - s * 2;
+		r.y = Field::mulSub(m, s - r.x, yy.sqr() * 8);
+		r.z = p.y * p.z * 2;
+	}
+	return r;
+}
+
+// Addition operation on the elliptic curve, in Jacobian coordinates
+// U1 = X1*Z2^2, U2 = X2*Z1^2, S1 = Y1*Z2^3, S2 = Y2*Z1^3, H = U2 - U1, R = S2 - S1
+// X3 = R^2 - H^3 - 2*U1*H^2, Y3 = R*(U1*H^2 - X3) - S1*H^3, Z3 = Z1*Z2*H
+// See: https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html
+template <class C>
+Jacobian<C> add(const Jacobian<C> &p, const Jacobian<C> &q)
+{
+	typedef typename C::Field Field;
+	if (p.z.isZero())
+		return q;
+	if (q.z.isZero())
+		return p;
+
+	Field z1z1 = p.z.sqr();
+	Field z2z2 = q.z.sqr();
+	Field u1 = p.x * z2z2;
+	Field u2 = q.x * z1z1;
+	Field s1 = p.y * q.z * z2z2;
+	Field s2 = q.y * p.z * z1z1;
+	Field h = u2 - u1;
+	Field r = s2 - s1;
+
+	// Same x: either the same point or p + (-p) = infinity
+	if (h.isZero())
+	{
+		if (r.isZero())
+			return dbl<C>(p);
+		return infinity<C>();
+	}
+
+	Field hh = h.sqr();
+	Field hhh = h * hh;
+	Field v = u1 * hh;
+	Jacobian<C> t;
+	t.x = r.sqr() - hhh - v * 2;
+	t.y = Field::mulSub(r, v - t.x, s1 * hhh);
+	t.z = p.z * q.z * h;
+	return t;
+}
+
+// Addition of an affine point q = (x2,y2,1) to a Jacobian point
+// Z2 = 1 saves the U1 and S1 products: 8M + 3S instead of 12M + 4S
+// U2 = X2*Z1^2, S2 = Y2*Z1^3, H = U2 - X1, R = S2 - Y1
+// X3 = R^2 - H^3 - 2*X1*H^2, Y3 = R*(X1*H^2 - X3) - Y1*H^3, Z3 = Z1*H
+template <class C>
+Jacobian<C> addMixed(const Jacobian<C> &p, const Point<C> &q)
+{
+	typedef typename C::Field Field;
+	if (q.x == 0 && q.y == 0)
+		return p;
+	if (p.z.isZero())
+		return toJacobian<C>(q);
+
+	Field z1z1 = p.z.sqr();
+	Field u2 = q.x * z1z1;
+	Field s2 = q.y * p.z * z1z1;
+	Field h = u2 - p.x;
+	Field r = s2 - p.y;
+
+	// Same x: either the same point or p + (-p) = infinity
+	if (h.isZero())
+	{
+		if (r.isZero())
+			return dbl<C>(p);
+		return infinity<C>();
+	}
+
+	Field hh = h.sqr();
+	Field hhh = h * hh;
+	Field v = p.x * hh;
+	Jacobian<C> t;
+	t.x = r.sqr() - hhh - v * 2;
+	t.y = Field::mulSub(r, v - t.x, p.y * hhh);
+	t.z = p.z * h;
+	return t;
+}
+
+// Jacobian to affine for len points with one inversion, see invAll()
+// Points at infinity have Z = 0, whose inverse is zero, so they become (0,0)
+template <class C>
+void toAffineAll(Point<C> *r, const Jacobian<C> *p, size_t len)
+{
+	typedef typename C::Field Field;
+	vector<Field> z(len), zi(len);
+	for (size_t i=0; i<len; i++)
+		z[i] = p[i].z;
+	Field::invAll(zi.data(), z.data(), len);
+	for (size_t i=0; i<len; i++)
+	{
+		Field zi2 = zi[i].sqr();
+		r[i] = Point<C>{p[i].x * zi2, p[i].y * zi2 * zi[i]};
+	}
+}
+
+// Window width of the variable base multiplication, the table holds
+// 2^(WNAF_WINDOW-2) points
+const int WNAF_WINDOW = 5;
+
+// Recode a 32 byte big endian number into width W non-adjacent form:
+// every digit is zero or odd with |digit| < 2^(W-1), and of any W
+// consecutive digits at most one is nonzero. Return the number of digits.
+template <int W>
+int wnaf(int *digits, const uint8_t *b)
+{
+	// Scalar as five 64 bit words, one spare for the carry of negative digits
+	uint64_t k[5] = {0, 0, 0, 0, 0};
+	for (int i=0; i<32; i++)
+		k[i/8] |= (uint64_t)b[31-i] << (8*(i%8));
+
+	int len = 0;
+	while (k[0] | k[1] | k[2] | k[3] | k[4])
+	{
+		int d = 0;
+		if (k[0] & 1)
+		{
+			// k mod 2^W, taken in (-2^(W-1), 2^(W-1)), is removed from k
+			d = k[0] & ((1 << W) - 1);
+			if (d >= (1 << (W-1)))
+				d -= 1 << W;
+			if (d > 0)
+				k[0] -= d;
+			else
+			{
+				// k + |d| with carry
+				uint64_t c = -d;
+				for (int j=0; j<5 && c; j++)
+				{
+					k[j] += c;
+					c = k[j] < c;
+				}
+			}
+		}
+		digits[len++] = d;
+		for (int j=0; j<4; j++)
+			k[j] = k[j] >> 1 | k[j+1] << 63;
+		k[4] >>= 1;
+	}
+	return len;
+}
+
+// Add digit d of a NAF, table holds the odd multiples 1, 3, 5, ... of a point
+template <class C>
+Jacobian<C> addDigit(const Jacobian<C> &p, int d, const Point<C> *table)
+{
+	if (d > 0)
+		return addMixed<C>(p, table[d/2]);
+	if (d < 0)
+	{
+		Point<C> t = table[(-d)/2];
+		t.y = -t.y;
+		return addMixed<C>(p, t);
+	}
+	return p;
+}
+
+// Multiply the point Q by sk with a width W NAF in variable time, only
+// for public values. The odd multiples Q, 3Q, ..., (2^(W-1)-1)Q are made
+// affine with one inversion, so every addition is a mixed one.
+// On curves with the GLV endomorphism sk is split into k1 + k2*LAMBDA
+// with halves of 128 bits. Both NAFs run interleaved over the same 128
+// doublings; the table of LAMBDA*Q is the table of Q with x times BETA.
+template <class C, int W = WNAF_WINDOW>
+Jacobian<C> scalarMulVar(const typename C::Scalar &sk, const Point<C> &Q)
+{
+	typedef typename C::Scalar Scalar;
+	const int size = 1 << (W-2);
+	if (Q.x == 0 && Q.y == 0)
+		return infinity<C>();
+
+	// Odd multiples of Q
+	Jacobian<C> odd[size];
+	odd[0] = toJacobian<C>(Q);
+	Jacobian<C> q2 = dbl<C>(odd[0]);
+	for (int i=1; i<size; i++)
+		odd[i] = add<C>(odd[i-1], q2);
+	Point<C> table[2][size];
+	toAffineAll<C>(table[0], odd, size);
+
+	// One scalar, or two halves of which negative ones use -k with -Q
+	Scalar k[2] = {sk, 0};
+	int streams = 1;
+	if constexpr (C::GLV)
+	{
+		sk.splitLambda(k[0], k[1]);
+		for (int i=0; i<size; i++)
+			table[1][i] = Point<C>{table[0][i].x * C::BETA, table[0][i].y};
+		for (int s=0; s<2; s++)
+		{
+			if (k[s].isHigh())
+			{
+				k[s] = -k[s];
+				for (int i=0; i<size; i++)
+					table[s][i].y = -table[s][i].y;
+			}
+		}
+		streams = 2;
+	}
+
+	// Recode once, then one doubling per digit and one addition per nonzero digit
+	int digits[2][257];
+	int len[2] = {0, 0};
+	for (int s=0; s<streams; s++)
+	{
+		uint8_t b[32];
+		k[s].toBytes32(b);
+		len[s] = wnaf<W>(digits[s], b);
+	}
+	Jacobian<C> pub = infinity<C>();
+	for (int i=max(len[0], len[1])-1; i>=0; i--)
+	{
+		pub = dbl<C>(pub);
+		for (int s=0; s<streams; s++)
+			if (i < len[s])
+				pub = addDigit<C>(pub, digits[s][i], table[s]);
+	}
+	return pub;
+}
+
+// Comb table of the generator, filled in by the generated GenTable.hpp:
+// comb[i][j] = (2*j+1) * 16^i * G in affine coordinates
+template <class C>
+struct GenTable;
+
+// Larger comb table mapped from a file, see GenTableMap.hpp
+template <class C>
+class GenTableMap;
+
+// Recode an odd 32 byte big endian number into ceil(256/w) signed odd
+// digits: k = sum d[i] * 2^(w*i) with d[i] odd and |d[i]| < 2^w
+// No digit is zero, so the recoding takes no branches on the value.
+// Return the number of digits.
+inline int combDigits(int *d, const uint8_t *b, int w)
+{
+	uint64_t k[4] = {0, 0, 0, 0};
+	for (int i=0; i<32; i++)
+		k[i/8] |= (uint64_t)b[31-i] << (8*(i%8));
+	int len = (256 + w - 1) / w;
+	uint64_t mask = (2ULL << w) - 1;
+	for (int i=0; i<len-1; i++)
+	{
+		// d = (k mod 2^(w+1)) - 2^w is odd, and (k - d)/2^w stays odd
+		d[i] = (int)(k[0] & mask) - (1 << w);
+		k[0] = (k[0] & ~mask) | (1ULL << w);
+		for (int j=0; j<3; j++)
+			k[j] = k[j] >> w | k[j+1] << (64 - w);
+		k[3] >>= w;
+	}
+	d[len-1] = (int)k[0];
+	return len;
+}
+
+// Widest mapped table used for secret scalars: a row of 2^(w-1) entries
+// is scanned per digit, and beyond 6 bits the scans cost more than the
+// additions they save
+const int COMB_SECRET_WINDOW = 6;
+
+// Multiply the generator by sk with a comb table: one table lookup and
+// mixed addition per digit, no doublings. The table mapped by GenTableMap
+// is used when present, the compiled-in one otherwise.
+// An even sk is replaced by the odd N - sk and the result negated.
+// With secret set, lookups scan a whole row of the table and the digits
+// are never zero, so memory access does not depend on sk; a mapped table
+// wider than COMB_SECRET_WINDOW is not used then. Otherwise the entry is
+// read directly, only for public values.
+template <class C>
+Jacobian<C> combMul(const typename C::Scalar &sk, bool secret)
+{
+	typedef typename C::Scalar Scalar;
+	if (sk.isZero())
+		return infinity<C>();
+	const GenTableMap<C> *map = GenTableMap<C>::get();
+	if (map && secret && map->window() > COMB_SECRET_WINDOW)
+		map = NULL;
+
+	uint8_t b[32];
+	sk.toBytes32(b);
+	int even = (b[31] & 1) ^ 1;
+	Scalar::select(sk, -sk, even).toBytes32(b);
+	int d[128];
+	int len = combDigits(d, b, map ? map->window() : 4);
+
+	Jacobian<C> r;
+	for (int i=0; i<len; i++)
+	{
+		// |d| and its sign without branches
+		int sign = d[i] >> 31;
+		int idx = ((d[i] ^ sign) - sign) >> 1;
+		Point<C> t;
+		if (map)
+			t = secret ? map->lookup(i, idx) : map->lookupVar(i, idx);
+		else
+			t = secret ? ctLookup(GenTable<C>::comb[i], 8, idx) : GenTable<C>::comb[i][idx];
+		t.cneg(sign & 1);
+		r = i == 0 ? toJacobian<C>(t) : addMixed<C>(r, t);
+	}
+	r.cneg(even);
+	return r;
+}
+
+// Multiply the generator by a secret sk, see combMul()
+template <class C>
+Jacobian<C> scalarMulGen(const typename C::Scalar &sk)
+{
+	return combMul<C>(sk, true);
+}
+
+// Multiply the generator by sk in variable time, only for public values
+template <class C>
+Jacobian<C> scalarMulGenVar(const typename C::Scalar &sk)
+{
+	return combMul<C>(sk, false);
+}
+#endif
@@ -9,41 +9,28 @@
 #include <gmpxx.h>        // mpz_class (bignum)
 #include <fcntl.h>        // O_RDONLY
 #include <unistd.h>       // READ, CLOSE
-#include <inttypes.h>     // printf uint64_t
+#include <string.h>       // memcpy, memset
+#include <stdlib.h>       // strtol
+#include <ctype.h>        // isdigit
 #include <fstream>
 #include "base64.h"
 #include "SHA256.h"
 #include "RIPEMD160.h"
-#include "GaloisField.hpp"
+#include "Curve.hpp"
+#include "PointOps.hpp"
+#include "GenTable.hpp"
+#include "GenTableMap.hpp"
 
 using namespace std;
 
-struct point
-{
-	GF x;
-	GF y;
-};
+typedef Point<Secp256k1> point;
 
-// Values for secp256k1
-class Curve
+// Convert a hex string to len bytes
+void hex2bytes(const string &hex, uint8_t *b, int len)
 {
-public:
-	mpz_class N;
-	mpz_class P;
-	point G;
-	Curve() // Constructor
-	{
-		mpz_class N("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141", 16);
-		mpz_class P("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F", 16);
-		mpz_class x("79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798", 16);
-		mpz_class y("483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8", 16);
-		this->G.x = GF(x,P);
-		this->G.y = GF(y,P);
-		this->N = N;
-		this->P = P;
-	}
-};
-Curve secp256k1;
+	for (int i=0; i<len; i++)
+		b[i] = stoul(hex.substr(2*i,2),nullptr,16);
+}
 
 // Get n bytes from /dev/random as hex string
 string readDevRandom(int n)
@@ -103,81 +90,83 @@ string readDevRandom(int n)
 }
 
 // Creates a random number with 256 bits
-GF genPriv()
+template <class C>
+typename C::Scalar genPriv()
 {
 	// 1 < sk < N -1
-	mpz_class key;
+	uint8_t b[32];
+	bool overflowed;
+	typename C::Scalar key;
 	do
 	{
-		key = mpz_class(readDevRandom(32),16);
-	} while (key <= 0 || key >= secp256k1.N);
-	return GF(key,secp256k1.P);
+		hex2bytes(readDevRandom(32), b, 32);
+		key = C::Scalar::fromBytes32(b, &overflowed);
+	} while (key.isZero() || overflowed);
+	return key;
 }
 
-// Addition operation on the elliptic curve
-// See: https://en.wikipedia.org/wiki/Elliptic_curve_point_multiplication#Point_addition
-point add(point p, point q)
+// Convert private key to public
+// Multiplies the generator by sk with the comb table, or Q if given.
+// Q is only given for public values in verification, that path runs in
+// variable time.
+template <class C>
+Point<C> priv2pub(const typename C::Scalar &sk, const Point<C> *Q=NULL)
 {
-	// Calculate lambda
-	GF lambda;
-	if (p.x == q.x && p.y == q.y)
-	{
-		lambda = ( p.x.pow(2) * 3 ) / ( p.y * 2 );
-	}
-	else
-	{
-		lambda = (q.y - p.y) / (q.x - p.x);
-	}
-
-	// Add points
-	point r;
-	r.x = lambda.pow(2) - p.x - q.x;
-	r.y = lambda * (p.x - r.x) - p.y;
-	return r;
+	if (Q != NULL)
+		return toAffine<C>(scalarMulVar<C>(sk, *Q));
+	return toAffine<C>(scalarMulGen<C>(sk));
 }
 
-// Convert private key to public
-point priv2pub(GF sk, point *Q=NULL)
+// Check the ECDSA signature (r,s) of a message digest with public key Q:
+// the x coordinate of (message/s)*G + (r/s)*Q must be r (mod N)
+template <class C>
+bool ecdsaVerify(const typename C::Scalar &message, const typename C::Scalar &r,
+                 const typename C::Scalar &s, const Point<C> &Q)
 {
-	// Copy generator
-	point G;
-	if (Q == NULL)
-	{
-		G.x = secp256k1.G.x;
-		G.y = secp256k1.G.y;	
-	}
-	else
-	{
-		G.x = Q->x;
-		G.y = Q->y;
-	}
+	if (r.isZero() || s.isZero())
+		return false;
+	typename C::Scalar w = s.invVar();
+	Point<C> X = toAffine<C>( add<C>( scalarMulGenVar<C>(message * w),
+	                                  scalarMulVar<C>(r * w, Q) ) );
+	uint8_t b[32];
+	X.x.toBytes32(b);
+	return C::Scalar::fromBytes32(b) == r;
+}
+
+// Create the ECDSA signature (r,s) of a message digest with privKey
+// Both numbers are written as 32 bytes. The signature is checked
+// against the public key before it is returned; that key is also
+// stored in pub if given. Return false if no signature passes the
+// check after SIGN_TRIES nonces, which means a broken table or field.
+const int SIGN_TRIES = 100;
 
-	// Compute G * sk
-	point pub;
-	pub.x = GF(0,secp256k1.P);
-	pub.y = GF(0,secp256k1.P);
-	mpz_class bit;
-	bit = 1;
-	for (int i=0; i<256; i++)
+template <class C>
+bool ecdsaSign(const typename C::Scalar &privKey, const typename C::Scalar &message,
+               uint8_t *bytesR, uint8_t *bytesS, Point<C> *pub=NULL)
+{
+	typedef typename C::Scalar Scalar;
+	Point<C> pubKey = priv2pub<C>(privKey);
+	if (pub != NULL)
+		*pub = pubKey;
+	for (int tries=0; tries<SIGN_TRIES; tries++)
 	{
-		mpz_class cmp = 0;
-		mpz_and (cmp.get_mpz_t(), bit.get_mpz_t(), sk.getNum().get_mpz_t());
-		if (cmp != 0)
+		// Create temporary private / public key
+		Scalar sk = genPriv<C>();
+		Point<C> pk = priv2pub<C>(sk);
+
+		// Create ECDSA signature
+		// https://www.instructables.com/id/Understanding-how-ECDSA-protects-your-data/
+		pk.x.toBytes32(bytesR);
+		Scalar R = Scalar::fromBytes32(bytesR);
+		Scalar S = Scalar::mulAdd(privKey, R, message) / sk;
+		if (ecdsaVerify<C>(message, R, S, pubKey))
 		{
-			if (pub.x == 0 && pub.y == 0)
-			{
-				pub.x = G.x;
-				pub.y = G.y;
-			}
-			else
-			{
-				pub = add(pub, G);
-			}
+			R.toBytes32(bytesR);
+			S.toBytes32(bytesS);
+			return true;
 		}
-		G = add(G, G);
-		bit = bit << 1;
 	}
-	return pub;
+	return false;
 }
 
 // Interface to external hash libraries
@@ -322,10 +311,7 @@ string binary2Addr(const string &str)
 string splitXY(string key, point &pk)
 {
 	string x = key.substr(2,64);
-	static mpz_class res;
-	static mpz_class mod = 2;
-	mpz_mod(res.get_mpz_t(), pk.y.getNum().get_mpz_t(), mod.get_mpz_t());
-	if (res == 0)
+	if (!pk.y.isOdd())
 		return "02" + x;
 	return "03" + x;
 }
@@ -354,113 +340,287 @@ string readFile(string file)
 	return tmp;
 }
 
-// Convert hex byte from string to int
-int hex2int(string h)
+// Read message file as raw bytes
+string readFileBytes(const string &file)
+{
+	ifstream input(file,ios::in | ios::binary);
+	if (!input)
+	{
+		cout << file << " file is not available." << endl;
+		exit(1);
+	}
+	return string(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+}
+
+// Load 64 hex digits as a 32 byte number, return false if malformed
+bool hexKey32(const string &hex, uint8_t *b)
+{
+	if (hex.length() != 64)
+		return false;
+	for (char c : hex)
+		if (!isxdigit((unsigned char)c))
+			return false;
+	hex2bytes(hex, b, 32);
+	return true;
+}
+
+// Write a 32 byte number as DER integer, return its length
+// Leading zero bytes are dropped and one zero byte is added if the most
+// significant bit is set, to avoid being interpreted as negative
+int derInt(uint8_t *out, const uint8_t *b)
+{
+	int skip = 0;
+	while (skip < 31 && b[skip] == 0)
+		skip++;
+	int len = 32 - skip;
+	int pad = b[skip] >> 7;
+	out[0] = 0x02;
+	out[1] = len + pad;
+	out[2] = 0;
+	memcpy(out + 2 + pad, b + skip, len);
+	return 2 + len + pad;
+}
+
+// Create signature in DER format: 0x30 len 0x02 lenR R 0x02 lenS S
+// and return it as base64
+string derEncode(const uint8_t *bytesR, const uint8_t *bytesS)
+{
+	uint8_t der[72];
+	int length = 2;
+	length += derInt(der + length, bytesR);
+	length += derInt(der + length, bytesS);
+	der[0] = 0x30;
+	der[1] = length - 2;
+	return base64_encode(der,length);
+}
+
+// Read the DER INTEGER at pos of sig as a 32 byte big endian number and
+// move pos past it. It must be 1 to 33 bytes long, non-negative and fit
+// in 32 bytes. With strict set it must also be minimally encoded: a
+// leading zero byte only before a byte >= 0x80. Without it redundant
+// leading zeros are allowed, as the original encoder padded every number
+// to 32 bytes.
+bool derReadInt(uint8_t *b, const string &sig, size_t &pos, bool strict)
+{
+	if (pos + 2 > sig.length() || (uint8_t)sig[pos] != 0x02)
+		return false;
+	size_t len = (uint8_t)sig[pos+1];
+	pos += 2;
+	if (len < 1 || len > 33 || pos + len > sig.length())
+		return false;
+	const uint8_t *v = (const uint8_t *)sig.data() + pos;
+	if (v[0] & 0x80)
+		return false;
+	if (strict && len > 1 && v[0] == 0 && !(v[1] & 0x80))
+		return false;
+	if (len == 33 && v[0] != 0)
+		return false;
+
+	memset(b, 0, 32);
+	size_t n = len < 32 ? len : 32;
+	memcpy(b + 32 - n, v + len - n, n);
+	pos += len;
+	return true;
+}
+
+// Get R and S from a base64 DER signature as 32 byte numbers
+// Only 0x30 len 0x02 lenR R 0x02 lenS S is accepted, with len covering
+// exactly the rest of the signature. Return false for anything else.
+// strict is passed on to derReadInt().
+bool derParse(const string &sigB64, uint8_t *bytesR, uint8_t *bytesS, bool strict)
+{
+	string sig = base64_decode(sigB64);
+	if (sig.length() < 2 || (uint8_t)sig[0] != 0x30 || (uint8_t)sig[1] != sig.length() - 2)
+		return false;
+	size_t pos = 2;
+	return derReadInt(bytesR, sig, pos, strict) && derReadInt(bytesS, sig, pos, strict) &&
+	       pos == sig.length();
+}
+
+// Sign a file on P-256 with a private key of 64 hex digits
+// The digest is the plain SHA-256 of the file, as used by OpenSSL
+int signP256(const string &file, const string &privHex)
+{
+	uint8_t keyBytes[32], digest[32];
+	bool overflowed;
+	if (!hexKey32(privHex, keyBytes))
+	{
+		cout << "The private key must have 64 hex digits." << endl;
+		return 1;
+	}
+	P256::Scalar privKey = P256::Scalar::fromBytes32(keyBytes, &overflowed);
+	if (privKey.isZero() || overflowed)
+	{
+		cout << "The private key is out of range." << endl;
+		return 1;
+	}
+	string data = readFileBytes(file);
+	computeSHA256(data.data(), data.length(), digest);
+	P256::Scalar message = P256::Scalar::fromBytes32(digest);
+
+	uint8_t bytesR[32], bytesS[32];
+	Point<P256> pubKey;
+	if (!ecdsaSign<P256>(privKey, message, bytesR, bytesS, &pubKey))
+	{
+		cout << "Signing failed: no signature passed the check." << endl;
+		return 1;
+	}
+	char pubBuf[131] = "04";
+	pubKey.x.toHex(pubBuf + 2);
+	pubKey.y.toHex(pubBuf + 66);
+	cout << "Signature = " << derEncode(bytesR, bytesS) << endl;
+	cout << "Public key = " << pubBuf << endl;
+	return 0;
+}
+
+// Load a P-256 public key, uncompressed (04 x y) or compressed (02/03 x)
+// Return false if it is malformed, a coordinate is not below P or the
+// point is not on the curve
+bool loadPubP256(const string &hex, Point<P256> &Q)
+{
+	bool compressed = hex.length() == 66 && (hex.compare(0,2,"02") == 0 || hex.compare(0,2,"03") == 0);
+	bool uncompressed = hex.length() == 130 && hex.compare(0,2,"04") == 0;
+	if (!compressed && !uncompressed)
+		return false;
+
+	uint8_t b[32];
+	bool overflowed;
+	if (!hexKey32(hex.substr(2,64), b))
+		return false;
+	Q.x = P256::Field::fromBytes32(b, &overflowed);
+	if (overflowed)
+		return false;
+	P256::Field alpha = Q.x.sqr() * Q.x - Q.x * 3 + P256::B;
+	if (uncompressed)
+	{
+		if (!hexKey32(hex.substr(66), b))
+			return false;
+		Q.y = P256::Field::fromBytes32(b, &overflowed);
+		return !overflowed && Q.y.sqr() == alpha;
+	}
+	if (alpha.jacobiVar() < 0 || !alpha.sqrt(Q.y))
+		return false;
+	if (Q.y.isOdd() != (hex[1] == '3'))
+		Q.y = -Q.y;
+	return true;
+}
+
+// Verify the P-256 signature of a file with a public key in hex
+int verifyP256(const string &file, const string &pubHex, const string &sigB64)
 {
-	char byte[3];
-	unsigned int hex;
-	byte[2] = 0;
-	byte[0] = h[0];
-	byte[1] = h[1];
-	byte[2] = 0;
-	sscanf(byte,"%x",&hex);
-	return (signed int)hex;
+	Point<P256> Q;
+	if (!loadPubP256(pubHex, Q))
+	{
+		cout << "Bad public key: expected 66 or 130 hex digits (02/03/04 prefix) of a P-256 point." << endl;
+		return 1;
+	}
+	uint8_t digest[32], bytesR[32], bytesS[32];
+	string data = readFileBytes(file);
+	computeSHA256(data.data(), data.length(), digest);
+	P256::Scalar message = P256::Scalar::fromBytes32(digest);
+
+	bool overR, overS;
+	if (!derParse(sigB64, bytesR, bytesS, true))
+	{
+		cout << "The signature is not valid DER." << endl;
+		return 1;
+	}
+	P256::Scalar R = P256::Scalar::fromBytes32(bytesR, &overR);
+	P256::Scalar S = P256::Scalar::fromBytes32(bytesS, &overS);
+	if (!overR && !overS && ecdsaVerify<P256>(message, R, S, Q))
+	{
+		cout << "Signature verification passed" << endl;
+		return 0;
+	}
+	cout << "Signature verification failed" << endl;
+	return 1;
+}
+
+// Write the generator table file of curve C with the given window
+template <class C>
+int genTable(const string &window)
+{
+	char *end;
+	long w = strtol(window.c_str(), &end, 10);
+	string file = GenTableMap<C>::fileName();
+	if (!isdigit((unsigned char)window[0]) || *end != '\0' || w < 2 || w > 16)
+	{
+		cout << "The window must be between 2 and 16 bits." << endl;
+		return 1;
+	}
+	if (!GenTableMap<C>::write(file, w))
+	{
+		cout << file << " could not be written." << endl;
+		return 1;
+	}
+	cout << "Generator table written to " << file << endl;
+	if (w > COMB_SECRET_WINDOW)
+		cout << "Signing only uses tables of up to " << COMB_SECRET_WINDOW << " bits, "
+		     << "this one speeds up verification only." << endl;
+	return 0;
 }
 
 int main(int argc, char **argv)
 {
 	// Check parameters
-	if ( !( (argc == 4 and string(argv[1]) == "sign") or
-			(argc == 5 and string(argv[1]) == "verify") ) )
+	string mode = argc > 1 ? argv[1] : "";
+	if ( !( (argc == 4 and (mode == "sign" or mode == "sign-p256")) or
+			(argc == 5 and (mode == "verify" or mode == "verify-p256")) or
+			(argc == 3 and mode == "gentable") or
+			(argc == 4 and mode == "gentable" and string(argv[3]) == "p256") ) )
 	{
 		cout << "ECDSA signature utility" << endl;
-		cout << "Usage: ./Ecdsa sign   <fileToBeSigned>  <WIF>" << endl;
-		cout << "       ./Ecdsa verify <fileToCheckSign> <pubKey> <signature>"
+		cout << "Usage: ./Ecdsa sign          <fileToBeSigned>  <WIF>" << endl;
+		cout << "       ./Ecdsa verify        <fileToCheckSign> <pubKey> <signature>" << endl;
+		cout << "       ./Ecdsa sign-p256     <fileToBeSigned>  <privKeyHex>" << endl;
+		cout << "       ./Ecdsa verify-p256   <fileToCheckSign> <pubKeyHex> <signature>" << endl;
+		cout << "       ./Ecdsa gentable      <windowBits> [p256]"
 			 << endl << endl;
 		return 1;
 	}
 
+	// Generator table file, used from the working directory when present
+	if (mode == "gentable")
+	{
+		if (argc == 4)
+			return genTable<P256>(argv[2]);
+		return genTable<Secp256k1>(argv[2]);
+	}
+
+	// NIST P-256 keys and signatures
+	if (mode == "sign-p256")
+		return signP256(argv[2], argv[3]);
+	if (mode == "verify-p256")
+		return verifyP256(argv[2], argv[3], argv[4]);
+
 	// Read file to be signed
 	// sha256(sha256(z)) of messageFile to be signed
 	string doubleSha = getHash(getHash(readFile(argv[2]),1),1);
-	mpz_class z(doubleSha,16);
-	GF message(z,secp256k1.N);
+	uint8_t digest[32];
+	hex2bytes(doubleSha, digest, 32);
+	FieldN message = FieldN::fromBytes32(digest);
 
 	// Sign the message using DER format
-	if (string(argv[1]) == "sign")
+	if (mode == "sign")
 	{
 		// Create Private Key / Public Key
 		string hex = decodeBase58(argv[3]);
 		hex = remMainCheck(hex);
-		GF privKey(mpz_class(hex,16),secp256k1.P);
-		point pubKey = priv2pub(privKey);
+		uint8_t keyBytes[32];
+		hex2bytes(hex, keyBytes, 32);
+		FieldN privKey = FieldN::fromBytes32(keyBytes);
 
 		// Loop until finds a valid signature
-		bool verify;
-		GF R,S;
-		do
+		uint8_t bytesR[32], bytesS[32];
+		if (!ecdsaSign<Secp256k1>(privKey, message, bytesR, bytesS))
 		{
-			do
-			{
-				// Create temporary private / public key
-				GF sk    = genPriv();
-				point pk = priv2pub(sk);
-
-				// Create ECDSA signature
-				// https://www.instructables.com/id/Understanding-how-ECDSA-protects-your-data/
-				R = pk.x;
-				S = ( message + GF(privKey.getNum(),secp256k1.N) 
-					  * GF(R.getNum(),secp256k1.N) ) 
-                      / GF(sk.getNum(),secp256k1.N);
-			} while ( R == GF(0,secp256k1.P) or S == GF(0,secp256k1.N) );
-
-			// Verify
-			point p = add( 	priv2pub(message/S),
-							priv2pub( GF(R.getNum(),secp256k1.N)/S, &pubKey) );
-			if (p.x == R)
-				verify = true;
-			else
-				verify = false;
-		} while (!verify);
-
-		// Create signature in DER format as hex string
-		char buf[143];
-		string strR, strS, strRS, der;
-
-		// Convert R
-		gmp_sprintf(buf,"%Z064x",R.getNum().get_mpz_t());
-		strR = buf;
-		if (strR[0] > '7')      // Add 00 if most significant bit is set
-			strR = "00" + strR; // to avoid being interpreted as negative
-
-		// Convert S
-		gmp_sprintf(buf,"%Z064x",S.getNum().get_mpz_t());
-		strS = buf;
-		if (strS[0] > '7')
-			strS = "00" + strS;
-
-		// Concatenate R and S with their lengths
-		sprintf(buf,"02%" PRIx64 "%s02%" PRIx64 "%s",
-			strR.length()/2,
-			strR.c_str(),
-			strS.length()/2,
-			strS.c_str());
-		strRS = buf;
-
-		// Conclude DER signature
-		sprintf(buf,"30%" PRIx64 "%s",
-			strRS.length()/2,
-			strRS.c_str());
-		der = buf;
-
-		// Convert string sig to base64
-		int length = der.length() / 2;
-		uint8_t *source = new uint8_t[length];
-		for (int i=0; i<(int)der.length(); i+=2)
-			source[i/2] = stoul(der.substr(i,2),nullptr,16);
-		string sigB64 = base64_encode(source,length);
+			cout << "Signing failed: no signature passed the check." << endl;
+			return 1;
+		}
+
+		// Convert sig to base64
+		string sigB64 = derEncode(bytesR, bytesS);
 		cout << "Signature = " << sigB64 << endl;
-		delete [] source;
 	}
 	else
 	{
@@ -468,38 +628,46 @@ int main(int argc, char **argv)
 		string pubKey = argv[3];
 		string sigB64 = argv[4];
 
-		// Convert signature from base64 to hex string
-		string sigBin = base64_decode(sigB64);
-		string der = "";
-		char buf[3];
-		for (int i=0; i<(int)sigBin.length(); i++)
+		// Get R and S from DER signature, both in [1, N-1]
+		// Signatures of older versions may pad R and S with zeros
+		uint8_t bytesR[32], bytesS[32];
+		bool overR, overS;
+		if (!derParse(sigB64, bytesR, bytesS, false))
 		{
-			sprintf(buf,"%02hhx",sigBin[i]);
-			der += buf;
+			cout << "The signature is not valid DER." << endl;
+			return 1;
+		}
+		FieldP R = FieldP::fromBytes32(bytesR);
+		FieldN rn = FieldN::fromBytes32(bytesR, &overR);
+		FieldN S = FieldN::fromBytes32(bytesS, &overS);
+		if (overR || overS || rn.isZero() || S.isZero())
+		{
+			cout << "Signature verification failed" << endl;
+			return 1;
 		}
-
-		// Get R and S from DER
-		string strR, strS;
-		int lenR, lenS;
-		lenR = hex2int(der.substr(6,2));
-		strR = der.substr(8,lenR*2);
-		lenS = hex2int(der.substr(8+lenR*2+2,2));
-		strS = der.substr(8+lenR*2+4,lenS*2);
-		GF R(mpz_class(strR,16),secp256k1.P);
-		GF S(mpz_class(strS,16),secp256k1.P);
 
 		// Recover public key from signature
 		// https://reinproject.org/static/bitcoin-signature-tool/js/bitcoinsig.js
 		// https://github.com/nanotube/supybot-bitcoin-marketmonitor/blob/master/GPG/local/bitcoinsig.py
 		bool found = false;
+		bool onCurve = false;
+		FieldP x, beta;
 		for (int i=0; i<4; i++)
 		{
 			// Calculate public key from signature
-			GF x = R + GF(secp256k1.N,secp256k1.P) * (i/2);
-			GF alpha = x.pow(3) + 7;
-			GF beta = alpha.pow((secp256k1.P+1)/4);
-			GF y;
-			if ( (beta-i)%2 == 0)
+			// Candidates come in pairs with the same x, so one root serves both
+			if (i % 2 == 0)
+			{
+				x = R + Secp256k1::N * (i/2);
+				FieldP alpha = x.sqr() * x + 7;
+				onCurve = alpha.jacobiVar() >= 0;  // Skip the square root if there is no point
+				if (onCurve)
+					alpha.sqrt(beta);
+			}
+			if (!onCurve)
+				continue;
+			FieldP y;
+			if ( (beta-i).isOdd() == false )
 				y =  beta;
 			else
 				y = -beta;
@@ -507,12 +675,14 @@ int main(int argc, char **argv)
 			point r;
 			r.x = x;
 			r.y = y;
-			point temp = add( priv2pub(S,&r) , priv2pub(-message) );
-			point Q = priv2pub( GF(R.getNum(),secp256k1.N).pow(-1) , &temp );
+			point temp = toAffine<Secp256k1>( add<Secp256k1>( scalarMulVar<Secp256k1>(S, r),
+			                                                  scalarMulGenVar<Secp256k1>(-message) ) );
+			point Q = priv2pub<Secp256k1>( rn.invVar() , &temp );
 
 			// Convert to base58check
-			char pubBuf[131];
-			gmp_sprintf(pubBuf, "04%Z064x%Z064x", Q.x.getNum().get_mpz_t(), Q.y.getNum().get_mpz_t());
+			char pubBuf[131] = "04";
+			Q.x.toHex(pubBuf + 2);
+			Q.y.toHex(pubBuf + 66);
 			string pub  = binary2Addr(pubBuf);
 			string pubC = binary2Addr(splitXY(pubBuf,Q));
 
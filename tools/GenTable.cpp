@@ -0,0 +1,74 @@
+// Title: Generator table builder
+// Description: Writes GenTable.hpp, the comb tables of the generators
+// used by scalarMulGen(). The Makefile runs it before building Ecdsa.
+
+#include <stdio.h>
+#include "Curve.hpp"
+#include "PointOps.hpp"
+
+using namespace std;
+
+// Print a coordinate as constructor call of four 64 bit words
+template <class F>
+void printField(const char *type, const F &v)
+{
+	uint8_t b[32];
+	v.toBytes32(b);
+	printf("%s(", type);
+	for (int j=0; j<4; j++)
+	{
+		uint64_t w = 0;
+		for (int k=0; k<8; k++)
+			w |= (uint64_t)b[31 - 8*j - k] << (8*k);
+		printf("0x%016llXULL%s", (unsigned long long)w, j < 3 ? ", " : ")");
+	}
+}
+
+// Compute and print comb[i][j] = (2*j+1) * 16^i * G
+template <class C>
+void printTable(const char *curve, const char *field)
+{
+	// All 512 points in Jacobian coordinates, made affine at once
+	vector<Jacobian<C>> jac(64*8);
+	Jacobian<C> base = toJacobian<C>(generator<C>());
+	for (int i=0; i<64; i++)
+	{
+		Jacobian<C> twice = dbl<C>(base);
+		jac[8*i] = base;
+		for (int j=1; j<8; j++)
+			jac[8*i+j] = add<C>(jac[8*i+j-1], twice);
+		for (int k=0; k<4; k++)
+			base = dbl<C>(base);
+	}
+	vector<Point<C>> aff(64*8);
+	toAffineAll<C>(aff.data(), jac.data(), aff.size());
+
+	printf("template <>\nstruct GenTable<%s>\n{\n", curve);
+	printf("\tstatic constexpr Point<%s> comb[64][8] = {\n", curve);
+	for (int i=0; i<64; i++)
+	{
+		printf("\t\t{  // 16^%d * G\n", i);
+		for (int j=0; j<8; j++)
+		{
+			printf("\t\t\t{");
+			printField(field, aff[8*i+j].x);
+			printf(",\n\t\t\t ");
+			printField(field, aff[8*i+j].y);
+			printf("}%s\n", j < 7 ? "," : "");
+		}
+		printf("\t\t}%s\n", i < 63 ? "," : "");
+	}
+	printf("\t};\n};\n\n");
+}
+
+int main()
+{
+	printf("#ifndef GUARD_GENTABLE\n#define GUARD_GENTABLE\n\n");
+	printf("// Comb tables of the generators, written by tools/GenTable.cpp\n");
+	printf("// Do not edit, the Makefile builds this file\n");
+	printf("#include \"PointOps.hpp\"\n\n");
+	printTable<Secp256k1>("Secp256k1", "FieldP");
+	printTable<P256>("P256", "FieldP256");
+	printf("#endif\n");
+	return 0;
+}